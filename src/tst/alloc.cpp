@@ -0,0 +1,140 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "alloc.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+
+#include "check.hpp"
+
+using namespace tst;
+
+namespace {
+std::atomic<bool> hook_installed{false};
+} // namespace
+
+namespace {
+// Must be trivially constructible, because it is accessed from operator new,
+// possibly before or after other thread local objects are constructed.
+struct thread_counters {
+	uint64_t num_allocs;
+	uint64_t num_bytes;
+
+	// can be negative in case the thread frees memory allocated by other thread
+	int64_t live_bytes;
+
+	int64_t base_live_bytes;
+	int64_t peak_live_bytes;
+};
+
+thread_local thread_counters counters;
+} // namespace
+
+bool alloc_tracker::is_installed() noexcept
+{
+	return hook_installed.load(std::memory_order_relaxed);
+}
+
+bool alloc_tracker::install() noexcept
+{
+	hook_installed.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+alloc_stats alloc_tracker::get_thread_stats() noexcept
+{
+	const auto& c = counters;
+	alloc_stats ret;
+	ret.num_allocs = c.num_allocs;
+	ret.num_bytes = c.num_bytes;
+	ret.peak_bytes = uint64_t(std::max(c.peak_live_bytes - c.base_live_bytes, int64_t(0)));
+	return ret;
+}
+
+void alloc_tracker::reset_thread_stats() noexcept
+{
+	auto& c = counters;
+	c.num_allocs = 0;
+	c.num_bytes = 0;
+	c.base_live_bytes = c.live_bytes;
+	c.peak_live_bytes = c.live_bytes;
+}
+
+void alloc_tracker::on_alloc(size_t size) noexcept
+{
+	auto& c = counters;
+	++c.num_allocs;
+	c.num_bytes += size;
+	c.live_bytes += int64_t(size);
+	c.peak_live_bytes = std::max(c.peak_live_bytes, c.live_bytes);
+}
+
+void alloc_tracker::on_free(size_t size) noexcept
+{
+	counters.live_bytes -= int64_t(size);
+}
+
+no_alloc_scope::no_alloc_scope(utki::source_location source_location) :
+	source_location(std::move(source_location)),
+	num_allocs_at_start(alloc_tracker::get_thread_stats().num_allocs),
+	num_uncaught_exceptions(std::uncaught_exceptions())
+{
+	if (!alloc_tracker::is_installed()) {
+		throw std::logic_error(
+			"no_alloc_scope: heap allocations are not tracked, "
+			"alloc_hook.hpp has to be included in the test application"
+		);
+	}
+}
+
+uint64_t no_alloc_scope::num_allocs() const noexcept
+{
+	return alloc_tracker::get_thread_stats().num_allocs - this->num_allocs_at_start;
+}
+
+// TODO: remove lint suppression when
+// https://github.com/llvm/llvm-project/issues/55143 is resolved
+// NOLINTNEXTLINE(bugprone-exception-escape)
+no_alloc_scope::~no_alloc_scope() noexcept(false)
+{
+	auto n = this->num_allocs();
+
+	// do not throw in case the scope is left due to exception
+	if (n == 0 || std::uncaught_exceptions() > this->num_uncaught_exceptions) {
+		return;
+	}
+
+	tst::check(
+		false,
+		[&](auto& o) {
+			o << n << " heap allocation(s) made within no_alloc_scope";
+		},
+		std::move(this->source_location)
+	);
+}
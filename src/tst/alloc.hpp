@@ -0,0 +1,160 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <utki/debug.hpp>
+
+namespace tst {
+
+/**
+ * @brief Heap allocation statistics.
+ */
+struct alloc_stats {
+	/**
+	 * @brief Number of allocations.
+	 */
+	uint64_t num_allocs = 0;
+
+	/**
+	 * @brief Total number of bytes allocated.
+	 */
+	uint64_t num_bytes = 0;
+
+	/**
+	 * @brief Peak number of bytes allocated and not yet freed.
+	 */
+	uint64_t peak_bytes = 0;
+};
+
+/**
+ * @brief Heap allocation tracker.
+ * Counts heap allocations made by each thread. The counting is only done in case
+ * the global operator new/delete are replaced by including alloc_hook.hpp,
+ * see alloc_hook.hpp for details.
+ * When the hook is installed, the allocations made by each test case are reported
+ * in the JUnit report.
+ */
+class alloc_tracker
+{
+public:
+	/**
+	 * @brief Check if operator new/delete hook is installed.
+	 * @return true if the allocations are counted.
+	 */
+	static bool is_installed() noexcept;
+
+	/**
+	 * @brief Get allocation statistics of the calling thread.
+	 * The statistics are counted since the last call to reset_thread_stats()
+	 * by the calling thread. The test runner resets the statistics right before running
+	 * each test case.
+	 * Memory freed by other thread than the one which has allocated it is accounted
+	 * to the freeing thread.
+	 * @return allocation statistics of the calling thread.
+	 */
+	static alloc_stats get_thread_stats() noexcept;
+
+	/**
+	 * @brief Reset allocation statistics of the calling thread.
+	 */
+	static void reset_thread_stats() noexcept;
+
+	/**
+	 * @brief Mark the operator new/delete hook as installed.
+	 * Called by alloc_hook.hpp.
+	 * @return true.
+	 */
+	static bool install() noexcept;
+
+	/**
+	 * @brief Count allocation.
+	 * Called by alloc_hook.hpp.
+	 * @param size - number of bytes allocated.
+	 */
+	static void on_alloc(size_t size) noexcept;
+
+	/**
+	 * @brief Count deallocation.
+	 * Called by alloc_hook.hpp.
+	 * @param size - number of bytes freed.
+	 */
+	static void on_free(size_t size) noexcept;
+};
+
+/**
+ * @brief Scope which must not do heap allocations.
+ * In case any heap allocation is made by the calling thread while the object is alive,
+ * the object fails the test case when it is destroyed, same way as failed check() does.
+ * Requires the allocations to be tracked, see alloc_hook.hpp.
+ * @code
+ * {
+ *     tst::no_alloc_scope no_alloc(SL);
+ *     // code which must not allocate
+ * }
+ * @endcode
+ */
+class no_alloc_scope
+{
+	utki::source_location source_location;
+	uint64_t num_allocs_at_start;
+	int num_uncaught_exceptions;
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @param source_location - object with source file:line information.
+	 * @throw std::logic_error - in case allocations are not tracked, see alloc_tracker::is_installed().
+	 */
+	no_alloc_scope(
+		utki::source_location source_location
+#if CFG_CPP >= 20
+		= utki::std_source_location::current()
+#endif
+	);
+
+	no_alloc_scope(const no_alloc_scope&) = delete;
+	no_alloc_scope& operator=(const no_alloc_scope&) = delete;
+
+	no_alloc_scope(no_alloc_scope&&) = delete;
+	no_alloc_scope& operator=(no_alloc_scope&&) = delete;
+
+	/**
+	 * @brief Get number of heap allocations made within the scope so far.
+	 * @return number of heap allocations made by the calling thread since the object was created.
+	 */
+	uint64_t num_allocs() const noexcept;
+
+	// TODO: remove lint suppression when
+	// https://github.com/llvm/llvm-project/issues/55143 is resolved
+	// NOLINTNEXTLINE(bugprone-exception-escape)
+	~no_alloc_scope() noexcept(false);
+};
+
+} // namespace tst
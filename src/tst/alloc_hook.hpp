@@ -0,0 +1,246 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+/*
+ * Replacement of global operator new/delete which counts heap allocations, see tst::alloc_tracker.
+ * Include this header in exactly one translation unit of the test application:
+ * @code
+ * #include <tst/alloc_hook.hpp>
+ * @endcode
+ * Including it in more than one translation unit results in multiple definition link errors.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "alloc.hpp"
+
+namespace tst::alloc_hook_internal {
+
+// Stored right before the memory block returned to the user.
+struct block_header {
+	size_t size;
+
+	// offset of the block from the pointer returned by malloc()
+	size_t offset;
+};
+
+constexpr const size_t header_size = alignof(std::max_align_t);
+
+static_assert(sizeof(block_header) <= header_size, "block_header does not fit into header space");
+
+inline void* try_allocate(size_t size, size_t alignment) noexcept
+{
+	size_t extra = header_size;
+	if (alignment > alignof(std::max_align_t)) {
+		extra += alignment - alignof(std::max_align_t);
+	}
+
+	if (size > SIZE_MAX - extra) {
+		return nullptr;
+	}
+
+	// NOLINTNEXTLINE(cppcoreguidelines-no-malloc, cppcoreguidelines-owning-memory)
+	auto raw = static_cast<uint8_t*>(std::malloc(size + extra));
+	if (!raw) {
+		return nullptr;
+	}
+
+	auto raw_addr = reinterpret_cast<uintptr_t>(raw);
+	auto addr = raw_addr + header_size;
+	if (alignment > alignof(std::max_align_t)) {
+		addr = (addr + alignment - 1) & ~(uintptr_t(alignment) - 1);
+	}
+
+	auto offset = size_t(addr - raw_addr);
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto block = raw + offset;
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	new (block - sizeof(block_header)) block_header{size, offset};
+
+	alloc_tracker::on_alloc(size);
+
+	return block;
+}
+
+inline void* allocate(size_t size, size_t alignment)
+{
+	for (;;) {
+		if (auto p = try_allocate(size, alignment)) {
+			return p;
+		}
+
+		auto handler = std::get_new_handler();
+		if (!handler) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+inline void* allocate_nothrow(size_t size, size_t alignment) noexcept
+{
+	try {
+		return allocate(size, alignment);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+inline void deallocate(void* p) noexcept
+{
+	if (!p) {
+		return;
+	}
+
+	auto block = static_cast<uint8_t*>(p);
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto header = reinterpret_cast<block_header*>(block - sizeof(block_header));
+
+	alloc_tracker::on_free(header->size);
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto allocated = block - header->offset;
+
+	// NOLINTNEXTLINE(cppcoreguidelines-no-malloc, cppcoreguidelines-owning-memory)
+	std::free(allocated);
+}
+
+// the hook is installed when the program is loaded
+const bool is_installed = alloc_tracker::install();
+
+} // namespace tst::alloc_hook_internal
+
+// NOLINTBEGIN(misc-new-delete-overloads, cert-dcl54-cpp, hicpp-new-delete-operators)
+
+void* operator new(size_t size)
+{
+	return tst::alloc_hook_internal::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size)
+{
+	return tst::alloc_hook_internal::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, const std::nothrow_t& /* tag */) noexcept
+{
+	return tst::alloc_hook_internal::allocate_nothrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& /* tag */) noexcept
+{
+	return tst::alloc_hook_internal::allocate_nothrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	return tst::alloc_hook_internal::allocate(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return tst::alloc_hook_internal::allocate(size, size_t(alignment));
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t& /* tag */) noexcept
+{
+	return tst::alloc_hook_internal::allocate_nothrow(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t& /* tag */) noexcept
+{
+	return tst::alloc_hook_internal::allocate_nothrow(size, size_t(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete(void* p, size_t /* size */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete[](void* p, size_t /* size */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t& /* tag */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t& /* tag */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t /* alignment */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t /* alignment */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete(void* p, size_t /* size */, std::align_val_t /* alignment */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete[](void* p, size_t /* size */, std::align_val_t /* alignment */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t /* alignment */, const std::nothrow_t& /* tag */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t /* alignment */, const std::nothrow_t& /* tag */) noexcept
+{
+	tst::alloc_hook_internal::deallocate(p);
+}
+
+// NOLINTEND(misc-new-delete-overloads, cert-dcl54-cpp, hicpp-new-delete-operators)
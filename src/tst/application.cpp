@@ -26,7 +26,19 @@ SOFTWARE.
 
 #include "application.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <ratio>
+#include <tuple>
+#include <unordered_map>
 
 #include <utki/config.hpp>
 #include <utki/exception.hpp>
@@ -37,10 +49,20 @@ SOFTWARE.
 #	include <nitki/queue.hpp>
 #endif
 
+#include "alloc.hpp"
+#include "bench_baseline.hxx"
+#include "benchmark.hxx"
 #include "iterator.hxx"
+#include "perf_counters.hxx"
+#include "process_pool.hxx"
 #include "reporter.hxx"
+#include "results_db.hxx"
+#include "scheduler.hxx"
 #include "set.hpp"
 #include "settings.hxx"
+#include "shard.hxx"
+#include "timings.hxx"
+#include "tracer.hxx"
 #include "util.hxx"
 
 #ifndef TST_NO_PAR
@@ -102,12 +124,208 @@ application::application(std::string name, std::string description) :
 #endif
 		}
 	);
+	this->cli.add(
+		"jobs-mode",
+		"How parallel jobs are run. Possible values:"
+		"\n"
+		"  thread = jobs are run in threads of the test application process."
+		"\n"
+		"  process = jobs are run in pre-forked worker processes. Tests marked as not thread safe are also run in "
+		"parallel in this mode. Not supported on Windows."
+		"\n"
+		"Default value is thread.",
+		[](std::string_view v) {
+			auto& s = tst::settings::inst();
+			if (v == "thread") {
+				s.jobs_in_processes = false;
+			} else if (v == "process") {
+#if CFG_OS == CFG_OS_WINDOWS
+				throw std::invalid_argument("--jobs-mode=process is not supported on Windows");
+#else
+				s.jobs_in_processes = true;
+#endif
+			} else {
+				throw std::invalid_argument("unknown --jobs-mode argument value");
+			}
+		}
+	);
+	this->cli.add(
+		"memory-budget",
+		"Memory budget in megabytes. Sum of memory weights of the tests running at the same time "
+		"does not exceed the budget. Default value is 0, which means unlimited.",
+		[](std::string_view v) {
+			tst::settings::inst().memory_budget_mb = utki::string_parser(v).read_number<size_t>();
+		}
+	);
+	this->cli.add(
+		"timeout",
+		"Timeout of a single test in milliseconds. In case a test runs longer than the timeout it is reported as "
+		"errored and the rest of the tests continue to run. Per-test timeouts set via test properties take "
+		"precedence. Timeouts are not enforced when running a single test with --test. "
+		"Default value is 0, which means no timeout.",
+		[](std::string_view v) {
+			tst::settings::inst().timeout_ms = utki::string_parser(v).read_number<uint32_t>();
+		}
+	);
+	this->cli.add(
+		"bench-time",
+		"Target time of one benchmark repetition in milliseconds. Number of iterations of the benchmark loop "
+		"is calibrated to run for at least this time. Default value is 100.",
+		[](std::string_view v) {
+			auto& s = tst::settings::inst();
+			s.bench_time_ms = utki::string_parser(v).read_number<uint32_t>();
+			if (s.bench_time_ms == 0) {
+				throw std::invalid_argument("--bench-time argument value must not be 0");
+			}
+		}
+	);
+	this->cli.add(
+		"bench-repetitions",
+		"Number of measured repetitions of each benchmark. Default value is 5.",
+		[](std::string_view v) {
+			auto& s = tst::settings::inst();
+			s.bench_repetitions = utki::string_parser(v).read_number<uint32_t>();
+			if (s.bench_repetitions == 0) {
+				throw std::invalid_argument("--bench-repetitions argument value must not be 0");
+			}
+		}
+	);
+	this->cli.add(
+		"bench-baseline",
+		"File to store benchmark results to. Results of benchmarks which were not run are kept in the file.",
+		[](std::string_view v) {
+			tst::settings::inst().bench_baseline_file = v;
+		}
+	);
+	this->cli.add(
+		"bench-compare",
+		"File with benchmark results to compare current benchmark results against, see --bench-baseline. "
+		"A benchmark which is slower than in the file by more than the threshold, see --bench-threshold, plus "
+		"the measurement noise is failed.",
+		[](std::string_view v) {
+			tst::settings::inst().bench_compare_file = v;
+		}
+	);
+	this->cli.add(
+		"bench-threshold",
+		"Allowed benchmark slowdown in percent, see --bench-compare. Default value is 10.",
+		[](std::string_view v) {
+			tst::settings::inst().bench_threshold =
+				double(utki::string_parser(v).read_number<uint32_t>()) / std::centi::den;
+		}
+	);
+	this->cli.add(
+		"perf-counters",
+		"Comma separated list of hardware performance counters to collect for each test, e.g. "
+		"'cycles,instructions'. The counts are written to the JUnit report as test case properties. "
+		"Known counters: cycles, instructions, cache-references, cache-misses, branches, branch-misses, "
+		"task-clock, page-faults, context-switches. Only supported on Linux.",
+		[](std::string_view v) {
+			auto& names = tst::settings::inst().perf_counters;
+			names.clear();
+			for (const auto& n : utki::split(v, ',')) {
+				if (!perf_counters::is_known(n)) {
+					std::stringstream ss;
+					ss << "unknown performance counter: " << n;
+					throw std::invalid_argument(ss.str());
+				}
+				if (std::find(names.begin(), names.end(), n) != names.end()) {
+					std::stringstream ss;
+					ss << "performance counter is listed more than once: " << n;
+					throw std::invalid_argument(ss.str());
+				}
+				names.push_back(n);
+			}
+			if (names.empty()) {
+				throw std::invalid_argument("--perf-counters argument value must not be empty");
+			}
+		}
+	);
 	this->cli.add("junit-out", "Output filename of the test report in JUnit format.", [](std::string_view v) {
 		tst::settings::inst().junit_report_out_file = v;
 	});
-	this->cli.add('l', "list-tests", "List all tests without running them.", []() {
-		tst::settings::inst().list_tests = true;
-	});
+	this->cli.add(
+		"junit-streaming",
+		"Write the JUnit report, see --junit-out, incrementally, as the test results arrive. The report file is "
+		"kept well-formed during the whole run, so that in case the run is aborted the results of the completed "
+		"tests are not lost. The results are buffered and written to the file about once a second.",
+		[]() {
+			tst::settings::inst().junit_streaming = true;
+		}
+	);
+	this->cli.add(
+		"trace-out",
+		"Output filename of the run timeline in Chrome trace event format. The file can be viewed with "
+		"chrome://tracing or Perfetto UI. The timeline contains all the test runs and phases of the whole run.",
+		[](std::string_view v) {
+			tst::settings::inst().trace_out_file = v;
+		}
+	);
+	this->cli.add(
+		"timings",
+		"File to read test durations of previous run from and to write test durations of the current run to. "
+		"Known test durations are used to start the longest tests first.",
+		[](std::string_view v) {
+			tst::settings::inst().timings_file = v;
+		}
+	);
+	this->cli.add(
+		"results-db",
+		"File of the binary test results database. The history of test results and durations is read from the "
+		"database before the run and the results of the current run are added to it after the run. "
+		"Known test durations are used to start the longest tests first.",
+		[](std::string_view v) {
+			tst::settings::inst().results_db_file = v;
+		}
+	);
+	this->cli.add(
+		"results-db-depth",
+		"Number of latest runs to keep per test in the results database. Default value is 10.",
+		[](std::string_view v) {
+			auto& s = tst::settings::inst();
+			s.results_db_depth = utki::string_parser(v).read_number<uint32_t>();
+			if (s.results_db_depth == 0) {
+				throw std::invalid_argument("--results-db-depth argument value must not be 0");
+			}
+		}
+	);
+	this->cli.add(
+		"shard-count",
+		"Total number of shards the tests are partitioned into, for running the tests on several machines. "
+		"Tests are balanced among shards by estimated duration if test durations history is available, "
+		"see --timings and --results-db, otherwise by number of tests. Default value is 1.",
+		[](std::string_view v) {
+			auto& s = tst::settings::inst();
+			s.shard_count = utki::string_parser(v).read_number<size_t>();
+			if (s.shard_count == 0) {
+				throw std::invalid_argument("--shard-count argument value must not be 0");
+			}
+		}
+	);
+	this->cli.add(
+		"shard-index",
+		"Index of the shard to run, from 0 to shard count - 1. Default value is 0.",
+		[](std::string_view v) {
+			tst::settings::inst().shard_index = utki::string_parser(v).read_number<size_t>();
+		}
+	);
+	this->cli.add(
+		'l',
+		"list-tests",
+		"List all tests without running them. In case a run list or a shard is given, only the tests of the run list "
+		"which belong to the shard are listed.",
+		[]() {
+			tst::settings::inst().list_tests = true;
+		}
+	);
+	this->cli.add(
+		"list-suites",
+		"List all test suites without running them. Test sets are not initialized, so this is fast even if "
+		"initialization of some test sets takes long.",
+		[]() {
+			tst::settings::inst().list_suites = true;
+		}
+	);
 	this->cli.add(
 		"about-to-run",
 		"Print name of the test about to run. By default, before the "
@@ -149,9 +367,13 @@ application::application(std::string name, std::string description) :
 	this->cli.add("run-list-stdin", "Get list of tests to run from stdin.", []() {
 		settings::inst().run_list_stdin = true;
 	});
-	this->cli.add("suite", "Run only specified test suite", [](std::string_view s) {
-		settings::inst().suite_name = s;
-	});
+	this->cli.add(
+		"suite",
+		"Run only specified test suite. Test sets of other suites are not initialized.",
+		[](std::string_view s) {
+			settings::inst().suite_name = s;
+		}
+	);
 	this->cli
 		.add("test", "Run only specified test case from the test suite specified via --suite.", [](std::string_view s) {
 			settings::inst().test_name = s;
@@ -175,13 +397,33 @@ void application::print_help() const
 
 size_t application::num_tests() const noexcept
 {
-	size_t ret = 0;
+	return this->test_table.size();
+}
 
-	for (const auto& s : this->suites) {
-		ret += s.second.size();
+void application::build_test_table()
+{
+	this->test_table.clear();
+	this->suite_ranges.clear();
+
+	// the suites are already sorted by name, so sorting tests within each suite
+	// makes the whole table sorted
+	for (auto& s : this->suites) {
+		s.second.sort_tests();
+		for (const auto& t : s.second.tests) {
+			for (size_t i = 0; i != t.num_tests; ++i) {
+				this->test_table.push_back({&s.first, &t, i, {}});
+			}
+		}
 	}
 
-	return ret;
+	for (size_t i = 0; i != this->test_table.size();) {
+		const auto& suite_name = *this->test_table[i].suite;
+		size_t end = i + 1;
+		for (; end != this->test_table.size() && this->test_table[end].suite == &suite_name; ++end) {
+		}
+		this->suite_ranges[suite_name] = {i, end};
+		i = end;
+	}
 }
 
 size_t application::run_list_size() const noexcept
@@ -199,17 +441,82 @@ suite& application::get_suite(std::string_view id)
 {
 	validate_id(id);
 
-	auto i = this->suites.emplace(id, suite());
-	return i.first->second;
+	auto i = this->suites.find(id);
+	if (i == this->suites.end()) {
+		i = this->suites.emplace(std::string(id), suite()).first;
+	}
+	return i->second;
 }
 
-void application::list_tests(std::ostream& o) const
+void application::list_suites(std::ostream& o)
 {
+	// Suite names are taken from the test sets, without initializing those, and from the suites
+	// which are added by the application's init(). The test sets are forgotten by init(), so
+	// the names are copied.
+	std::set<std::string, std::less<>> names;
+	for (const auto& i : set::get_inits()) {
+		names.emplace(i.first);
+	}
+	for (auto ss = static_set::head; ss; ss = ss->next) {
+		names.emplace(ss->suite_name);
+	}
+
+	// none of the test sets is initialized
+	this->suites_to_init.emplace();
+	this->init();
+
 	for (const auto& s : this->suites) {
-		o << s.first << '\n';
-		for (const auto& t : s.second.tests) {
-			o << '\t' << t.first << '\n';
+		names.insert(s.first);
+	}
+
+	for (const auto& n : names) {
+		o << n << '\n';
+	}
+}
+
+void application::list_tests(std::ostream& o) const
+{
+	std::vector<iterator> selected_tests;
+
+	auto in_run_list = this->select_run_list();
+	for (iterator i(*this); i.is_valid(); i.next()) {
+		if (in_run_list[i.index()]) {
+			selected_tests.push_back(i);
+		}
+	}
+
+	// list only the tests of the shard, the shard is selected same way as when running the tests
+	std::vector<bool> in_shard;
+	if (settings::inst().shard_count > 1) {
+		timings durations;
+		if (!settings::inst().timings_file.empty()) {
+			durations.load(settings::inst().timings_file);
+		}
+		if (!settings::inst().results_db_file.empty()) {
+			results_db db;
+			db.open(settings::inst().results_db_file);
+			durations.load(db);
+		}
+
+		in_shard = select_shard(
+			selected_tests,
+			durations,
+			settings::inst().shard_index,
+			settings::inst().shard_count
+		);
+	}
+
+	const std::string* cur_suite = nullptr;
+	for (size_t n = 0; n != selected_tests.size(); ++n) {
+		if (!in_shard.empty() && !in_shard[n]) {
+			continue;
+		}
+		const auto& r = this->test_table[selected_tests[n].index()];
+		if (r.suite != cur_suite) {
+			cur_suite = r.suite;
+			o << *cur_suite << '\n';
 		}
+		o << '\t' << selected_tests[n].id().test << '\n';
 	}
 }
 
@@ -302,6 +609,22 @@ void print_passed_test_name(std::ostream& o, const full_id& id)
 }
 } // namespace
 
+namespace {
+void print_benchmark_result(std::ostream& o, const full_id& id, const benchmark_result& b)
+{
+	std::stringstream ss;
+	if (settings::inst().colored_output) {
+		ss << "\033[1;34mbench\033[0m: ";
+	} else {
+		ss << "bench: ";
+	}
+	print_test_name(ss, id);
+	ss << "  " << b.ns_per_op << " ns/op, stddev " << b.stddev_ns << " ns, " << b.iterations << " iterations x "
+	   << b.repetitions << '\n';
+	o << ss.str();
+}
+} // namespace
+
 namespace {
 void print_error_info(std::ostream& o, const tst::check_failed& e, bool color = settings::inst().colored_output)
 {
@@ -316,22 +639,48 @@ void print_error_info(std::ostream& o, const tst::check_failed& e, bool color =
 } // namespace
 
 namespace {
-void run_test(const full_id& id, const std::function<void()>& proc, reporter& rep, bool no_catch = false)
+// The is_abandoned function is called right after the test procedure returns. In case it returns true,
+// the test result has already been reported by the watchdog, so nothing is printed.
+reporter::result run_test_proc(
+	const full_id& id,
+	const iterator& test,
+	bool no_catch,
+	const std::function<bool()>& is_abandoned = nullptr
+)
 {
 	print_test_name_about_to_run(std::cout, id);
 
 	std::string console_error_message;
 
-	ASSERT(proc)
+	perf_counters* perf = nullptr;
+	if (!settings::inst().perf_counters.empty()) {
+		perf = &perf_counters::this_thread();
+	}
+
 	uint32_t start_ticks = utki::get_ticks_ms();
 
+	reporter::result ret;
+
 	auto run_proc = [&]() -> bool {
 		try {
-			proc();
-			uint32_t dt = utki::get_ticks_ms() - start_ticks;
-			rep.report_pass(id, dt);
+			alloc_tracker::reset_thread_stats();
+			if (perf) {
+				perf->start();
+			}
+			test.run();
+			auto allocs = alloc_tracker::get_thread_stats();
+			std::vector<uint64_t> perf_counts;
+			if (perf) {
+				perf_counts = perf->stop();
+			}
 
-			print_passed_test_name(std::cout, id);
+			uint32_t dt = utki::get_ticks_ms() - start_ticks;
+			ret = reporter::result::pass(dt);
+			ret.benchmark = benchmark_runner::take_result();
+			ret.perf_counts = std::move(perf_counts);
+			if (alloc_tracker::is_installed()) {
+				ret.allocs = allocs;
+			}
 			return true;
 		} catch (tst::check_failed& e) {
 			uint32_t dt = utki::get_ticks_ms() - start_ticks;
@@ -343,38 +692,59 @@ void run_test(const full_id& id, const std::function<void()>& proc, reporter& re
 			{
 				std::stringstream ss;
 				print_error_info(ss, e, false);
-				rep.report_failure(id, dt, ss.str());
+				ret = reporter::result::failure(dt, ss.str());
 			}
 		}
 		return false;
 	};
 
+	bool passed = false;
 	if (no_catch) {
-		if (run_proc()) {
-			return;
-		}
+		passed = run_proc();
 	} else {
 		try {
-			if (run_proc()) {
-				return;
-			}
+			passed = run_proc();
 		} catch (std::exception& e) {
 			uint32_t dt = utki::get_ticks_ms() - start_ticks;
 			std::stringstream ss;
 			ss << "  uncaught exception:\n"sv << utki::to_string(e, "    "sv);
 			console_error_message = ss.str();
-			rep.report_error(id, dt, std::string(console_error_message));
+			ret = reporter::result::error(dt, console_error_message);
 		} catch (...) {
 			uint32_t dt = utki::get_ticks_ms() - start_ticks;
 			std::stringstream ss;
 			ss << "  uncaught exception:\n"sv << utki::current_exception_to_string("    "sv);
 			console_error_message = ss.str();
-			rep.report_error(id, dt, std::string(console_error_message));
+			ret = reporter::result::error(dt, console_error_message);
+		}
+	}
+
+	if (is_abandoned && is_abandoned()) {
+		return ret;
+	}
+
+	if (passed) {
+		print_passed_test_name(std::cout, id);
+		if (ret.benchmark) {
+			print_benchmark_result(std::cout, id, ret.benchmark.value());
 		}
+		return ret;
 	}
 
 	print_failed_test_name(std::cout, id);
 	std::cout << console_error_message << '\n';
+
+	return ret;
+}
+} // namespace
+
+namespace {
+reporter::result run_test(const full_id& id, const iterator& test, bool no_catch = false)
+{
+	auto begin_us = tracer::now_us();
+	auto ret = run_test_proc(id, test, no_catch);
+	tracer::record_test(id, ret.status, {begin_us, tracer::now_us()});
+	return ret;
 }
 } // namespace
 
@@ -384,14 +754,62 @@ const auto main_thread_id = std::this_thread::get_id();
 } // namespace
 #endif
 
-int application::run()
+namespace {
+// returns zero if the test has no timeout
+uint32_t get_timeout_ms(const iterator& i)
 {
-	if (this->num_tests() == 0) {
-		std::cout << "no tests to run" << std::endl;
-		return 0;
+	auto timeout = uint32_t(i.info().props.timeout.count());
+	if (timeout == 0) {
+		return settings::inst().timeout_ms;
+	}
+	return timeout;
+}
+} // namespace
+
+namespace {
+std::vector<size_t> make_tasks(const std::vector<iterator>& tests, const timings& durations)
+{
+	std::vector<size_t> tasks(tests.size());
+	std::iota(tasks.begin(), tasks.end(), 0);
+
+	// start longest tests first, so that a long test does not end up
+	// being the tail of the run
+	if (!durations.empty()) {
+		std::vector<uint32_t> estimates;
+		estimates.reserve(tests.size());
+		for (const auto& t : tests) {
+			auto id = t.id();
+			estimates.push_back(durations.estimate(id.suite, id.test));
+		}
+		std::stable_sort(tasks.begin(), tasks.end(), [&estimates](size_t a, size_t b) {
+			return estimates[a] > estimates[b];
+		});
 	}
 
+	return tasks;
+}
+} // namespace
+
 #ifndef TST_NO_PAR
+namespace {
+// Maximum time between checks for timed out tests.
+constexpr const uint32_t watchdog_period_ms = 100;
+
+constexpr const size_t no_task = std::numeric_limits<size_t>::max();
+
+// State of a runner shared between the runner thread and the main thread.
+// Shared ownership is needed because an abandoned runner thread can outlive the test run.
+struct runner_state {
+	std::atomic<size_t> task{no_task};
+	std::atomic<uint32_t> start_ticks{0};
+	std::atomic<uint64_t> begin_us{0};
+};
+} // namespace
+
+namespace {
+// returns number of abandoned runners, these are left stuck in hung tests
+size_t run_tests_in_threads(const std::vector<iterator>& tests, scheduler& sched, reporter& rep)
+{
 	// set up queue for the main thread
 	opros::wait_set wait_set(1);
 	nitki::queue queue;
@@ -400,149 +818,634 @@ int application::run()
 		wait_set.remove(queue);
 	});
 
-	runners_pool pool;
-#endif
+	runners_pool pool(sched.num_workers());
+
+	std::vector<std::shared_ptr<runner_state>> states(pool.size());
+
+	size_t num_active_runners = pool.size();
+	size_t num_abandoned_runners = 0;
+
+	// Each runner takes tests from the scheduler on its own until there are no
+	// tests left, so the main thread does not take part in dispatching.
+	auto start_runner = [&](size_t i) {
+		auto state = std::make_shared<runner_state>();
+		states[i] = state;
+		pool.get(i).push_back([i, state, &sched, &tests, &rep, &queue, &num_active_runners]() {
+			while (auto t = sched.pop(i)) {
+				const auto& test = tests[*t];
+				auto id = test.id();
+
+				auto begin_us = tracer::now_us();
+				state->begin_us.store(begin_us, std::memory_order_relaxed);
+				state->start_ticks.store(utki::get_ticks_ms(), std::memory_order_relaxed);
+				state->task.store(*t, std::memory_order_release);
+
+				bool is_abandoned = false;
+				auto result = run_test_proc(id, test, false, [&]() {
+					// once the task is taken back from the runner state, the watchdog cannot time out the test
+					is_abandoned = state->task.exchange(no_task) != *t;
+					return is_abandoned;
+				});
+
+				if (is_abandoned) {
+					// The test has timed out and this runner has been abandoned,
+					// all the variables captured by reference can be already destroyed.
+					// The test result has been reported by the watchdog, so the trace event
+					// is not recorded either, it could race with writing the trace file.
+					return;
+				}
 
-	reporter rep(*this);
+				tracer::record_test(id, result.status, {begin_us, tracer::now_us()});
 
-	rep.print_num_tests_about_to_run(std::cout);
+				sched.done(*t);
 
-	bool is_single_test = !settings::inst().test_name.empty();
+				rep.report_result(test, std::move(result));
+			}
+			queue.push_back([&num_active_runners]() {
+				ASSERT(std::this_thread::get_id() == main_thread_id)
+				ASSERT(num_active_runners != 0)
+				--num_active_runners;
+			});
+		});
+	};
 
-	ASSERT(!is_single_test || (this->run_list.size() == 1 && this->run_list.begin()->second.size() == 1))
+	for (size_t i = 0; i != pool.size(); ++i) {
+		start_runner(i);
+	}
 
-	// TODO: add timeout
+	bool has_timeouts = std::any_of(tests.begin(), tests.end(), [](const auto& t) {
+		return get_timeout_ms(t) != 0;
+	});
 
-	uint32_t start_ticks = utki::get_ticks_ms();
+	// The main thread acts as a watchdog, it checks if a runner is running its test
+	// for longer than the test's timeout. Such runner is abandoned and a new runner
+	// takes its place.
+	// Returns number of milliseconds after which the timeouts have to be checked again.
+	auto check_timeouts = [&]() {
+		uint32_t ret = watchdog_period_ms;
 
-	std::vector<iterator> no_parallel_tests;
+		auto now = utki::get_ticks_ms();
+		for (size_t i = 0; i != states.size(); ++i) {
+			auto& state = *states[i];
 
-	for (iterator i(this->suites); true;) {
-		if (i.is_valid()) {
-			utki::scope_exit iter_next_scope_exit([&i]() {
-				i.next();
-			});
+			auto t = state.task.load(std::memory_order_acquire);
+			if (t == no_task) {
+				continue;
+			}
 
-			auto id = i.id();
-			if (!this->is_in_run_list(id.suite, id.test)) {
-				print_skipped_test_name(std::cout, id);
-				rep.report_skipped(id, "not in run list");
+			ASSERT(t < tests.size())
+			auto timeout = get_timeout_ms(tests[t]);
+			if (timeout == 0) {
 				continue;
 			}
 
-			if (i.info().flags.get(flag::disabled)) {
-				print_disabled_test_name(std::cout, id);
-				rep.report_disabled_test(id);
+			uint32_t time_ms = now - state.start_ticks.load(std::memory_order_relaxed);
+			if (time_ms < timeout) {
+				ret = std::min(ret, timeout - time_ms);
 				continue;
 			}
 
-			if (settings::inst().num_threads > 1) {
-				if (i.info().flags.get(flag::no_parallel)) {
-					no_parallel_tests.push_back(i);
-					continue;
-				}
+			if (!state.task.compare_exchange_strong(t, no_task)) {
+				// the test has just completed
+				continue;
 			}
 
-			auto& proc = i.info().proc;
-			ASSERT(proc)
+			auto id = tests[t].id();
+			std::stringstream ss;
+			ss << "test timed out after " << time_ms << " ms";
+			auto message = ss.str();
+			ss.str(std::string());
+
+			print_failed_test_name(ss, id);
+			ss << "  " << message << '\n';
+			std::cout << ss.str();
+
+			auto result = reporter::result::error(time_ms, std::move(message));
+			tracer::record_test(id, result.status, {state.begin_us.load(std::memory_order_relaxed), tracer::now_us()});
+			rep.report_result(tests[t], std::move(result));
+
+			// The hung test keeps running, so its exclusive resources stay acquired.
+			// The tests which cannot run without those are reported as errors.
+			for (auto r : sched.abandon(t)) {
+				constexpr auto not_run_message =
+					"test not run, it uses a resource held by a timed out test which is still running"sv;
+
+				std::stringstream ss;
+				print_failed_test_name(ss, tests[r].id());
+				ss << "  " << not_run_message << '\n';
+				std::cout << ss.str();
+
+				rep.report_result(tests[r], reporter::result::error(0, std::string(not_run_message)));
+			}
+
+			pool.abandon(i);
+			++num_abandoned_runners;
+			start_runner(i);
+		}
+
+		return ret;
+	};
+
+	while (num_active_runners != 0) {
+		std::optional<uint32_t> wait_ms;
+		if (has_timeouts) {
+			wait_ms = check_timeouts();
+		}
+
+		// the streamed JUnit report is flushed also while no test completes, e.g. during a long test
+		if (rep.is_junit_streamed()) {
+			auto flush_ms = rep.flush_junit_if_due();
+			wait_ms = std::min(wait_ms.value_or(flush_ms), flush_ms);
+		}
+
+		if (wait_ms) {
+			wait_set.wait(wait_ms.value());
+		} else {
+			wait_set.wait();
+		}
+		while (auto f = queue.pop_front()) {
+			f();
+		}
+	}
+
+	pool.stop_all_runners();
+
+	return num_abandoned_runners;
+}
+} // namespace
+#endif
+
+#if CFG_OS != CFG_OS_WINDOWS
+namespace {
+void run_tests_in_processes(const std::vector<iterator>& tests, scheduler& sched, reporter& rep)
+{
+	// the streamed JUnit report is flushed also while no test completes, e.g. during a long test
+	process_pool::on_tick_type flush_junit;
+	if (rep.is_junit_streamed()) {
+		flush_junit = [&rep]() {
+			return rep.flush_junit_if_due();
+		};
+	}
+
+	process_pool pool(sched.num_workers(), [&tests](size_t task) {
+		ASSERT(task < tests.size())
+		const auto& test = tests[task];
+		return run_test(test.id(), test);
+	});
+
+	pool.run(
+		sched,
+		[&tests](size_t task) {
+			ASSERT(task < tests.size())
+			return get_timeout_ms(tests[task]);
+		},
+		[&tests, &rep](size_t worker, size_t task, reporter::result result, trace_span span) {
+			ASSERT(task < tests.size())
+			auto id = tests[task].id();
+			tracer::record_test(id, result.status, span, worker);
+			rep.report_result(tests[task], std::move(result));
+		},
+		[&tests, &rep](size_t worker, size_t task, uint32_t time_ms, std::string message) {
+			ASSERT(task < tests.size())
+			auto id = tests[task].id();
+			print_failed_test_name(std::cout, id);
+			std::cout << "  " << message << '\n';
+			auto result = reporter::result::error(time_ms, std::move(message));
+
+			auto end_us = tracer::now_us();
+			auto begin_us = end_us - std::min(end_us, uint64_t(time_ms) * std::milli::den);
+			tracer::record_test(id, result.status, {begin_us, end_us}, worker);
+
+			rep.report_result(tests[task], std::move(result));
+		},
+		flush_junit
+	);
+}
+} // namespace
+#endif
+
+namespace {
+std::vector<scheduler::requirements> make_task_requirements(const std::vector<iterator>& tests)
+{
+	std::vector<scheduler::requirements> ret(tests.size());
+
+	bool has_requirements = false;
+
+	// map resource names to indices
+	std::unordered_map<std::string_view, size_t> resources;
+
+	for (size_t i = 0; i != tests.size(); ++i) {
+		const auto& props = tests[i].info().props;
+		auto& r = ret[i];
+
+		for (const auto& name : props.resources) {
+			auto index = resources.emplace(name, resources.size()).first->second;
+			if (std::find(r.resources.begin(), r.resources.end(), index) == r.resources.end()) {
+				r.resources.push_back(index);
+			}
+		}
+
+		r.cpu_weight = props.cpu_weight;
+		r.memory_weight = props.memory_weight_mb;
+
+		has_requirements = has_requirements || !r.resources.empty() || r.cpu_weight != 1 || r.memory_weight != 0;
+	}
+
+	if (!has_requirements) {
+		return {};
+	}
+
+	return ret;
+}
+} // namespace
+
+namespace {
+// returns number of runner threads left stuck in hung tests
+size_t run_tests_in_parallel(const std::vector<iterator>& tests, const timings& durations, reporter& rep)
+{
+	if (tests.empty()) {
+		return 0;
+	}
+
+	scheduler sched(std::min(size_t(settings::inst().num_threads), tests.size()));
+	sched.distribute(make_tasks(tests, durations));
+	{
+		// There are never more tests running at the same time than there are workers, so the number of workers is
+		// the CPU budget, also in case the number of jobs is unlimited. Larger weights are reduced to the budget.
+		scheduler::budgets limits;
+		limits.cpu = sched.num_workers();
+		if (settings::inst().memory_budget_mb != 0) {
+			limits.memory = settings::inst().memory_budget_mb;
+		}
+		sched.set_task_requirements(make_task_requirements(tests), limits);
+	}
+
+#if CFG_OS != CFG_OS_WINDOWS
+	if (settings::inst().jobs_in_processes) {
+		run_tests_in_processes(tests, sched, rep);
+		return 0;
+	}
+#endif
 
-			if (is_single_test) {
-				// when running a single test indicated by --test command line option we
-				// don't want to catch exceptions to allow debugger show the correct
-				// stack trace
-				run_test(
-					id,
-					proc,
-					rep,
-					true // no exception catching
-				);
-			} else {
 #ifndef TST_NO_PAR
-				auto r = pool.occupy_runner();
-				if (r) {
-					auto reply = [&pool, r]() {
-						ASSERT(std::this_thread::get_id() == main_thread_id)
-						pool.free_runner(r);
-					};
-
-					r->push_back([id, &proc, &rep, &queue, reply = std::move(reply)]() {
-						run_test(id, proc, rep);
-						queue.push_back(std::move(reply));
-					});
-					continue;
-				}
-				iter_next_scope_exit.release();
+	return run_tests_in_threads(tests, sched, rep);
 #else
-				run_test(id, proc, rep);
+	for (const auto& t : tests) {
+		auto id = t.id();
+		rep.report_result(t, run_test(id, t));
+	}
+	return 0;
 #endif
-			}
-		} else
+}
+} // namespace
+
+namespace {
+// returns number of runner threads left stuck in hung tests
+size_t run_tests_serially(const std::vector<iterator>& tests, reporter& rep)
+{
 #ifndef TST_NO_PAR
-			if (pool.no_active_runners())
+	// Tests with timeout are run in a separate thread, so that the main thread can watch the timeout.
+	// Same for the streamed JUnit report, so that the main thread can flush it during a long test.
+	if (rep.is_junit_streamed() || std::any_of(tests.begin(), tests.end(), [](const auto& t) {
+			return get_timeout_ms(t) != 0;
+		}))
+	{
+		std::vector<size_t> tasks(tests.size());
+		std::iota(tasks.begin(), tasks.end(), 0);
+
+		scheduler sched(1);
+		sched.distribute(tasks);
+
+		return run_tests_in_threads(tests, sched, rep);
+	}
 #endif
-		{
-			// no tests left and no active runners
-			break;
+
+	for (const auto& i : tests) {
+		auto id = i.id();
+		rep.report_result(i, run_test(id, i));
+	}
+	return 0;
+}
+} // namespace
+
+namespace {
+void update_timings(iterator i, timings& durations)
+{
+	for (; i.is_valid(); i.next()) {
+		if (!i.result().has_run()) {
+			continue;
 		}
+		auto id = i.id();
+		durations.set(id.suite, id.test, i.result().time_ms);
+	}
+}
+} // namespace
 
-#ifndef TST_NO_PAR
-		if (!is_single_test) {
-			// no free runners, or no tests left, wait on the queue
-			wait_set.wait();
-			ASSERT(wait_set.get_triggered().size() == 1)
-			auto f = queue.pop_front();
-			ASSERT(f)
-			f();
+namespace {
+void update_results_db(iterator i, const results_db& db, int64_t timestamp)
+{
+	std::vector<results_db::entry> entries;
+
+	// ids of parametrized test cases are composed on demand, they are stored until the entries are written
+	std::deque<std::string> indexed_ids;
+
+	for (; i.is_valid(); i.next()) {
+		if (!i.result().has_run()) {
+			continue;
 		}
-#endif
-	} // ~main loop
+		auto id = i.id();
 
-	// non-parallel run loop
-	for (const auto& i : no_parallel_tests) {
-		run_test(i.id(), i.info().proc, rep);
+		results_db::entry e = {};
+		e.suite = id.suite;
+		e.test = i.info().is_parametrized ? std::string_view(indexed_ids.emplace_back(id.test)) : id.test;
+		e.run.timestamp = timestamp;
+		e.run.duration_ms = i.result().time_ms;
+		e.run.status = uint8_t(i.result().result);
+
+		entries.push_back(e);
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+		return std::make_tuple(a.suite, a.test) < std::make_tuple(b.suite, b.test);
+	});
+
+	db.write(settings::inst().results_db_file, settings::inst().results_db_depth, entries);
+}
+} // namespace
+
+namespace {
+void compare_benchmarks(iterator i, const bench_baseline& baseline, reporter& rep)
+{
+	for (; i.is_valid(); i.next()) {
+		const auto& b = i.result().benchmark;
+		if (!b) {
+			continue;
+		}
+		auto id = i.id();
+
+		const auto* base = baseline.find(id.suite, id.test);
+		if (!base) {
+			continue;
+		}
+
+		auto message = check_regression(b.value(), *base, settings::inst().bench_threshold);
+		if (message.empty()) {
+			continue;
+		}
+
+		print_failed_test_name(std::cout, id);
+		std::cout << "  " << message << '\n';
+
+		rep.report_regression(i, std::move(message));
+	}
+}
+} // namespace
+
+namespace {
+void update_bench_baseline(iterator i, const std::string& file_name)
+{
+	bench_baseline baseline;
+	baseline.load(file_name);
+
+	for (; i.is_valid(); i.next()) {
+		const auto& b = i.result().benchmark;
+		if (!b) {
+			continue;
+		}
+		auto id = i.id();
+		baseline.set(id.suite, id.test, b.value());
+	}
+
+	baseline.save(file_name);
+}
+} // namespace
+
+int application::run()
+{
+	if (this->num_tests() == 0) {
+		std::cout << "no tests to run" << std::endl;
+		return 0;
+	}
+
+	reporter rep(*this);
+
+	rep.print_num_tests_about_to_run(std::cout);
+
+	bool is_single_test = !settings::inst().test_name.empty();
+
+	ASSERT(!is_single_test || (this->run_list.size() == 1 && this->run_list.begin()->second.size() == 1))
+
+	timings durations;
+	if (!settings::inst().timings_file.empty()) {
+		durations.load(settings::inst().timings_file);
+	}
+
+	results_db db;
+	if (!settings::inst().results_db_file.empty()) {
+		db.open(settings::inst().results_db_file);
+		durations.load(db);
+	}
+
+	bench_baseline compare_baseline;
+	if (!settings::inst().bench_compare_file.empty()) {
+		compare_baseline.load(settings::inst().bench_compare_file);
+	}
+
+	if (!settings::inst().perf_counters.empty()) {
+		// open the counters early, so that in case they are unavailable the run fails right away
+		perf_counters::this_thread();
+	}
+
+	auto run_timestamp = int64_t(std::time(nullptr));
+
+	uint32_t start_ticks = utki::get_ticks_ms();
+
+	std::vector<iterator> parallel_tests;
+	std::vector<iterator> no_parallel_tests;
+
+	std::vector<iterator> selected_tests;
+
+	auto in_run_list = this->select_run_list();
+
+	for (iterator i(*this); i.is_valid(); i.next()) {
+		auto id = i.id();
+		if (!in_run_list[i.index()]) {
+			print_skipped_test_name(std::cout, id);
+			rep.report_skipped(i, "not in run list");
+			continue;
+		}
+		selected_tests.push_back(i);
+	}
+
+	std::vector<bool> in_shard;
+	if (settings::inst().shard_count > 1) {
+		in_shard = select_shard(
+			selected_tests,
+			durations,
+			settings::inst().shard_index,
+			settings::inst().shard_count
+		);
+	}
+
+	for (size_t n = 0; n != selected_tests.size(); ++n) {
+		const auto& i = selected_tests[n];
+		auto id = i.id();
+
+		if (!in_shard.empty() && !in_shard[n]) {
+			print_skipped_test_name(std::cout, id);
+			rep.report_skipped(i, "not in shard");
+			continue;
+		}
+
+		if (i.info().flags.get(flag::disabled)) {
+			print_disabled_test_name(std::cout, id);
+			rep.report_disabled_test(i);
+			continue;
+		}
+
+		if (is_single_test) {
+			// when running a single test indicated by --test command line option we
+			// don't want to catch exceptions to allow debugger show the correct
+			// stack trace
+			rep.report_result(
+				i,
+				run_test(
+					id,
+					i,
+					true // no exception catching
+				)
+			);
+			continue;
+		}
+
+		// benchmarks are run one by one after other tests, so that other tests do not affect the measurements
+		if (i.info().is_benchmark) {
+			no_parallel_tests.push_back(i);
+			continue;
+		}
+
+		if (settings::inst().num_threads > 1) {
+			const auto& flags = i.info().flags;
+			if (flags.get(flag::no_parallel) ||
+				(flags.get(flag::not_thread_safe) && !settings::inst().jobs_in_processes))
+			{
+				no_parallel_tests.push_back(i);
+				continue;
+			}
+		}
+
+		parallel_tests.push_back(i);
+	}
+
+	size_t num_hung_threads = 0;
+
+	{
+		trace_phase phase("parallel tests");
+		num_hung_threads += run_tests_in_parallel(parallel_tests, durations, rep);
+	}
+
+	{
+		trace_phase phase("serial tests");
+		num_hung_threads += run_tests_serially(no_parallel_tests, rep);
 	}
 
 	rep.time_ms = utki::get_ticks_ms() - start_ticks;
 
+	auto reports_begin_us = tracer::now_us();
+
+	if (!settings::inst().bench_compare_file.empty()) {
+		compare_benchmarks(iterator(*this), compare_baseline, rep);
+	}
+
 	rep.print_num_tests_run(std::cout);
 	rep.print_num_tests_passed(std::cout);
 	rep.print_num_tests_disabled(std::cout);
 	rep.print_num_tests_skipped(std::cout);
 	rep.print_num_tests_failed(std::cout);
+	rep.print_num_benchmark_regressions(std::cout);
 	rep.print_num_warnings(std::cout);
 	rep.print_outcome(std::cout);
 
-#ifndef TST_NO_PAR
-	pool.stop_all_runners();
-#endif
+	if (!settings::inst().timings_file.empty()) {
+		update_timings(iterator(*this), durations);
+		durations.save(settings::inst().timings_file);
+	}
+
+	if (!settings::inst().bench_baseline_file.empty()) {
+		update_bench_baseline(iterator(*this), settings::inst().bench_baseline_file);
+	}
+
+	if (!settings::inst().results_db_file.empty()) {
+		update_results_db(iterator(*this), db, run_timestamp);
+	}
 
 	{
 		auto& junit_file = settings::inst().junit_report_out_file;
-		if (!junit_file.empty()) {
+		if (rep.is_junit_streamed()) {
+			rep.finish_junit_report();
+		} else if (!junit_file.empty()) {
 			rep.write_junit_report(junit_file);
 		}
 	}
 
-	return rep.is_failed() ? 1 : 0;
+	if (tracer::is_enabled()) {
+		tracer::record_phase("reports", {reports_begin_us, tracer::now_us()});
+		tracer::write(settings::inst().trace_out_file);
+	}
+
+	int ret = rep.is_failed() ? 1 : 0;
+
+	if (num_hung_threads != 0) {
+		// Threads stuck in hung tests cannot be joined, and destroying the objects
+		// those threads may still be using is unsafe, so exit right away.
+		std::cout.flush();
+		std::_Exit(ret);
+	}
+
+	return ret;
 }
 
-bool application::is_in_run_list(const std::string& suite, const std::string& test) const
+std::vector<bool> application::select_run_list() const
 {
 	if (this->run_list.empty()) {
-		return true;
-	}
-	auto si = this->run_list.find(suite);
-	if (si == this->run_list.end()) {
-		return false;
+		return std::vector<bool>(this->test_table.size(), true);
 	}
-	const auto& set = si->second;
-	if (!set.empty()) {
-		auto ti = set.find(test);
-		if (ti == set.end()) {
-			return false;
+
+	std::vector<bool> ret(this->test_table.size(), false);
+
+	for (const auto& s : this->run_list) {
+		auto ri = this->suite_ranges.find(s.first);
+		if (ri == this->suite_ranges.end()) {
+			continue;
+		}
+		auto [begin, end] = ri->second;
+
+		auto si = this->suites.find(s.first);
+		ASSERT(si != this->suites.end())
+
+		if (s.second.empty()) {
+			std::fill(std::next(ret.begin(), ptrdiff_t(begin)), std::next(ret.begin(), ptrdiff_t(end)), true);
+			continue;
+		}
+
+		// test records of a suite go in the order of the suite's sorted tests
+		auto first = std::next(this->test_table.begin(), ptrdiff_t(begin));
+		auto last = std::next(this->test_table.begin(), ptrdiff_t(end));
+		for (const auto& test : s.second) {
+			auto key = si->second.find(test);
+			if (!key.first) {
+				continue;
+			}
+			auto ti = std::lower_bound(first, last, key, [](const auto& r, const auto& k) {
+				return std::make_pair(r.info, r.param_index) < k;
+			});
+			if (ti != last && ti->info == key.first && ti->param_index == key.second) {
+				ret[size_t(std::distance(this->test_table.begin(), ti))] = true;
+			}
 		}
 	}
-	return true;
+
+	return ret;
 }
 
 namespace {
@@ -603,13 +1506,20 @@ void application::read_run_list_from_stdin()
 		return;
 	}
 
+	std::stringstream ss;
+	ss << std::cin.rdbuf();
+	this->run_list_text = ss.str();
+}
+
+void application::parse_run_list()
+{
 	bool expect_test_name = false;
 
 	std::string_view cur_suite_name;
 	const suite* cur_suite = nullptr;
 	decltype(this->run_list)::value_type::second_type* cur_run_list_suite = nullptr;
 
-	std::istream& is = std::cin;
+	std::istringstream is(this->run_list_text);
 
 	size_t line = 0;
 
@@ -636,14 +1546,13 @@ void application::read_run_list_from_stdin()
 							);
 						}
 
-						auto i = cur_suite->tests.find(tn);
-						if (i == cur_suite->tests.end()) {
+						if (!cur_suite->find(tn).first) {
 							std::stringstream ss;
 							ss << "test '" << tn << "' not found in suite '" << cur_suite_name << '\'';
 							throw std::invalid_argument(ss.str());
 						}
 						ASSERT(cur_run_list_suite)
-						cur_run_list_suite->insert(std::string_view(i->first));
+						cur_run_list_suite->insert(std::move(tn));
 					} else {
 						throw_syntax_error_invalid_char(line, c);
 					}
@@ -688,6 +1597,45 @@ void application::read_run_list_from_stdin()
 	}
 }
 
+namespace {
+// Collects names of the suites mentioned in the run list. Suite names start at the beginning of a line.
+std::set<std::string, std::less<>> collect_run_list_suites(std::string_view text)
+{
+	std::set<std::string, std::less<>> ret;
+
+	while (!text.empty()) {
+		auto end = text.find('\n');
+		auto line = text.substr(0, end);
+		text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+
+		size_t len = 0;
+		for (; len != line.size() && is_valid_id_char(line[len]); ++len) {
+		}
+		if (len != 0) {
+			ret.emplace(line.substr(0, len));
+		}
+	}
+
+	return ret;
+}
+} // namespace
+
+void application::select_suites_to_init()
+{
+	const auto& s = settings::inst();
+	if (!s.suite_name.empty()) {
+		this->suites_to_init = {s.suite_name};
+	} else if (s.run_list_stdin) {
+		this->read_run_list_from_stdin();
+		auto suites = collect_run_list_suites(this->run_list_text);
+
+		// empty run list means that all tests are run
+		if (!suites.empty()) {
+			this->suites_to_init = std::move(suites);
+		}
+	}
+}
+
 void application::set_run_list_from_suite_and_test_name()
 {
 	const auto& suite_name = settings::inst().suite_name;
@@ -701,30 +1649,139 @@ void application::set_run_list_from_suite_and_test_name()
 
 	const auto& test_name = settings::inst().test_name;
 	if (!test_name.empty()) {
-		const auto& tests = i->second.tests;
-		auto j = tests.find(test_name);
-		if (j == tests.end()) {
+		if (!i->second.find(test_name).first) {
 			std::stringstream ss;
 			ss << "Test case --suite=" << suite_name << " --test=" << test_name << " not found";
 			throw std::invalid_argument(ss.str());
 		}
 
-		set.insert(j->first);
+		set.insert(test_name);
 	}
 }
 
+namespace {
+// Initialization of one test suite by all of its test sets.
+struct suite_init_task {
+	std::string_view suite_name;
+	const std::vector<std::function<void(suite&)>>* inits = nullptr;
+	std::vector<utki::span<const test_entry>> tables;
+	suite* s = nullptr;
+
+	bool is_empty = false;
+	std::exception_ptr error;
+
+	void run() noexcept
+	{
+		try {
+			for (const auto& t : this->tables) {
+				this->s->add(t);
+			}
+			if (this->inits) {
+				auto old_size = this->s->size();
+				for (const auto& p : *this->inits) {
+					ASSERT(p)
+					p(*this->s);
+				}
+				this->is_empty = old_size == this->s->size();
+			}
+		} catch (...) {
+			this->error = std::current_exception();
+		}
+	}
+};
+} // namespace
+
+namespace {
+// Each task fills its own suite, so with several jobs the tasks are run concurrently.
+void run_suite_init_tasks(std::vector<suite_init_task>& tasks)
+{
+#ifndef TST_NO_PAR
+	size_t num_runners = std::min(size_t(settings::inst().num_threads), tasks.size());
+	if (num_runners > 1) {
+		opros::wait_set wait_set(1);
+		nitki::queue queue;
+		wait_set.add(queue, {opros::ready::read}, &queue);
+		utki::scope_exit queue_scope_exit([&wait_set, &queue]() {
+			wait_set.remove(queue);
+		});
+
+		runners_pool pool(num_runners);
+
+		std::atomic<size_t> next_task{0};
+		size_t num_active_runners = pool.size();
+
+		for (size_t i = 0; i != pool.size(); ++i) {
+			pool.get(i).push_back([&tasks, &next_task, &queue, &num_active_runners]() {
+				for (auto t = next_task.fetch_add(1); t < tasks.size(); t = next_task.fetch_add(1)) {
+					tasks[t].run();
+				}
+				queue.push_back([&num_active_runners]() {
+					ASSERT(std::this_thread::get_id() == main_thread_id)
+					ASSERT(num_active_runners != 0)
+					--num_active_runners;
+				});
+			});
+		}
+
+		while (num_active_runners != 0) {
+			wait_set.wait();
+			while (auto f = queue.pop_front()) {
+				f();
+			}
+		}
+
+		pool.stop_all_runners();
+		return;
+	}
+#endif
+
+	for (auto& t : tasks) {
+		t.run();
+		if (t.error) {
+			break;
+		}
+	}
+}
+} // namespace
+
 void application::init()
 {
+	auto is_selected = [this](std::string_view suite_name) {
+		return !this->suites_to_init || this->suites_to_init->find(suite_name) != this->suites_to_init->end();
+	};
+
+	std::map<std::string_view, suite_init_task> suite_tasks;
 	for (const auto& i : set::get_inits()) {
-		auto& s = this->get_suite(i.first);
-		auto old_size = s.size();
-		for (const auto& p : i.second) {
-			ASSERT(p)
-			p(s);
+		if (is_selected(i.first)) {
+			suite_tasks[i.first].inits = &i.second;
+		}
+	}
+	for (auto ss = static_set::head; ss; ss = ss->next) {
+		if (is_selected(ss->suite_name)) {
+			suite_tasks[ss->suite_name].tables.push_back(ss->tests);
+		}
+	}
+
+	// create all suites beforehand, so that the tasks do not modify the suites map
+	std::vector<suite_init_task> tasks;
+	tasks.reserve(suite_tasks.size());
+	for (auto& i : suite_tasks) {
+		i.second.suite_name = i.first;
+		i.second.s = &this->get_suite(i.first);
+		tasks.push_back(std::move(i.second));
+	}
+
+	run_suite_init_tasks(tasks);
+
+	// errors and warnings are reported in order of suite names, regardless of
+	// the order in which the suites were initialized
+	for (const auto& t : tasks) {
+		if (t.error) {
+			std::rethrow_exception(t.error);
 		}
-		if (old_size == s.size()) {
+		if (t.is_empty) {
 			std::stringstream ss;
-			ss << "some test set for suite '" << i.first << "' is empty";
+			ss << "some test set for suite '" << t.suite_name << "' is empty";
 			++this->num_warnings;
 			print_warning(std::cout, ss.str());
 		}
@@ -27,10 +27,13 @@ SOFTWARE.
 #pragma once
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include <clargs/parser.hpp>
 #include <utki/config.hpp>
@@ -60,11 +63,42 @@ class application
 	const std::string name;
 	const std::string description;
 
-	std::unordered_map<std::string, suite> suites;
+	// Suites sorted by name. std::less<> allows lookup by std::string_view without
+	// constructing a temporary std::string.
+	std::map<std::string, suite, std::less<>> suites;
 
-	std::unordered_map<std::string_view, std::set<std::string_view>> run_list;
+	struct test_record {
+		const std::string* suite;
+		const suite::test_info* info;
 
-	bool is_in_run_list(const std::string& suite, const std::string& test) const;
+		// index of the test case in the parametrized test case range
+		size_t param_index;
+
+		suite::test_result result;
+	};
+
+	// All tests sorted by suite and test names, built once after init() by
+	// concatenating the sorted tests of the sorted suites. Test cases of a parametrized
+	// test case go in the order of their parameter indices.
+	// Index of a test in the table is used as the test's integer id on the run path.
+	std::vector<test_record> test_table;
+
+	// ranges of suites' tests in the test table
+	std::unordered_map<std::string_view, std::pair<size_t, size_t>> suite_ranges;
+
+	void build_test_table();
+
+	std::unordered_map<std::string_view, std::set<std::string, std::less<>>> run_list;
+
+	// Names of the suites whose test sets are initialized by init().
+	// In case there is no value, all test sets are initialized.
+	std::optional<std::set<std::string, std::less<>>> suites_to_init;
+
+	// run list read from stdin before init(), it is parsed after init()
+	std::string run_list_text;
+
+	// returns flags of tests in the run list, indexed by test ids
+	std::vector<bool> select_run_list() const;
 
 	void print_help() const;
 
@@ -74,9 +108,14 @@ class application
 
 	size_t run_list_size() const noexcept;
 
+	// calls init() without initializing the test sets
+	void list_suites(std::ostream& o);
 	void list_tests(std::ostream& o) const;
 
+	void select_suites_to_init();
+
 	void read_run_list_from_stdin();
+	void parse_run_list();
 	void set_run_list_from_suite_and_test_name();
 
 	size_t num_warnings = 0;
@@ -105,7 +144,9 @@ public:
 	 * @brief Initialize test cases.
 	 * This function is called by tst right after command line arguments have been
 	 * parsed. The default implementation of the function adds test cases to the
-	 * application from all tst::set instances.
+	 * application from all tst::set instances. In case only some test suites are
+	 * selected to run, with --suite or with a run list, then only the sets of those
+	 * suites are initialized.
 	 */
 	virtual void init();
 
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "bench_baseline.hxx"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace tst;
+
+void bench_baseline::load(const std::string& file_name)
+{
+	std::ifstream f(file_name, std::ios::binary);
+	if (!f.is_open()) {
+		return;
+	}
+
+	std::string line;
+	for (size_t line_num = 1; std::getline(f, line); ++line_num) {
+		if (line.empty() || line.front() == '#') {
+			continue;
+		}
+
+		std::istringstream ss(line);
+
+		std::string suite;
+		std::string test;
+		benchmark_result r;
+
+		ss >> suite >> test >> r.ns_per_op >> r.stddev_ns >> r.iterations >> r.repetitions;
+		if (ss.fail()) {
+			std::stringstream err;
+			err << "error in benchmark baseline file '" << file_name << "' syntax at line: " << line_num;
+			throw std::invalid_argument(err.str());
+		}
+
+		this->suites[suite][test] = r;
+	}
+}
+
+void bench_baseline::save(const std::string& file_name) const
+{
+	std::ofstream f(file_name, std::ios::binary);
+
+	f << "# benchmark results: <suite> <benchmark> <ns/op> <stddev ns> <iterations> <repetitions>" << '\n';
+
+	for (const auto& s : this->suites) {
+		for (const auto& t : s.second) {
+			const auto& r = t.second;
+			f << s.first << ' ' << t.first << ' ' << r.ns_per_op << ' ' << r.stddev_ns << ' ' << r.iterations << ' '
+			  << r.repetitions << '\n';
+		}
+	}
+
+	f.flush();
+}
+
+void bench_baseline::set(std::string_view suite, std::string_view test, const benchmark_result& result)
+{
+	auto si = this->suites.find(suite);
+	if (si == this->suites.end()) {
+		si = this->suites.emplace(std::string(suite), decltype(si->second)()).first;
+	}
+
+	auto ti = si->second.find(test);
+	if (ti == si->second.end()) {
+		si->second.emplace(std::string(test), result);
+	} else {
+		ti->second = result;
+	}
+}
+
+const benchmark_result* bench_baseline::find(std::string_view suite, std::string_view test) const
+{
+	auto si = this->suites.find(suite);
+	if (si == this->suites.end()) {
+		return nullptr;
+	}
+
+	auto ti = si->second.find(test);
+	if (ti == si->second.end()) {
+		return nullptr;
+	}
+
+	return &ti->second;
+}
+
+namespace {
+constexpr const double noise_num_standard_errors = 3;
+} // namespace
+
+std::string tst::check_regression(const benchmark_result& result, const benchmark_result& baseline, double threshold)
+{
+	auto variance_of_mean = [](const benchmark_result& r) {
+		if (r.repetitions == 0) {
+			return 0.0;
+		}
+		return r.stddev_ns * r.stddev_ns / r.repetitions;
+	};
+
+	double noise_ns = noise_num_standard_errors * std::sqrt(variance_of_mean(result) + variance_of_mean(baseline));
+
+	double allowed_ns = baseline.ns_per_op * (1 + threshold) + noise_ns;
+
+	if (result.ns_per_op <= allowed_ns) {
+		return {};
+	}
+
+	std::stringstream ss;
+	ss << "benchmark regression: " << result.ns_per_op << " ns/op, baseline " << baseline.ns_per_op << " ns/op";
+	if (baseline.ns_per_op > 0) {
+		ss << " (+" << ((result.ns_per_op / baseline.ns_per_op - 1) * 100) << "%)";
+	}
+	ss << ", allowed up to " << allowed_ns << " ns/op";
+	return ss.str();
+}
@@ -0,0 +1,92 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "benchmark.hpp"
+
+namespace tst {
+
+/**
+ * @brief Benchmark results baseline.
+ * Benchmark results stored from a previous run, used to detect performance regressions.
+ */
+class bench_baseline
+{
+	// std::less<> allows lookup by std::string_view without constructing a temporary std::string
+	std::map<std::string, std::map<std::string, benchmark_result, std::less<>>, std::less<>> suites;
+
+public:
+	/**
+	 * @brief Load baseline from file.
+	 * In case the file does not exist, nothing is loaded.
+	 * @param file_name - name of the file to load baseline from.
+	 * @throw std::invalid_argument - in case of syntax error in the file.
+	 */
+	void load(const std::string& file_name);
+
+	/**
+	 * @brief Save baseline to file.
+	 * @param file_name - name of the file to save baseline to.
+	 */
+	void save(const std::string& file_name) const;
+
+	/**
+	 * @brief Set benchmark result.
+	 * @param suite - test suite name.
+	 * @param test - benchmark name.
+	 * @param result - benchmark result.
+	 */
+	void set(std::string_view suite, std::string_view test, const benchmark_result& result);
+
+	/**
+	 * @brief Find benchmark result.
+	 * @param suite - test suite name.
+	 * @param test - benchmark name.
+	 * @return pointer to the benchmark result.
+	 * @return nullptr if there is no result for the benchmark.
+	 */
+	const benchmark_result* find(std::string_view suite, std::string_view test) const;
+};
+
+/**
+ * @brief Check benchmark result for performance regression.
+ * The benchmark is regressed in case its time is larger than the baseline time by more than
+ * the threshold plus the measurement noise. The noise is estimated as three standard errors
+ * of the difference of the mean times.
+ * @param result - benchmark result.
+ * @param baseline - baseline benchmark result.
+ * @param threshold - allowed relative slowdown, e.g. 0.1 for 10%.
+ * @return description of the regression.
+ * @return empty string if there is no regression.
+ */
+std::string check_regression(const benchmark_result& result, const benchmark_result& baseline, double threshold);
+
+} // namespace tst
@@ -0,0 +1,136 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "benchmark.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <ratio>
+#include <stdexcept>
+#include <vector>
+
+#include <utki/debug.hpp>
+
+#include "settings.hxx"
+
+using namespace tst;
+
+namespace {
+constexpr const uint64_t max_iterations = 1'000'000'000;
+
+// maximal growth of number of iterations between calibration steps
+constexpr const double max_calibration_multiplier = 10;
+
+// aim a bit above the target time to not end up just below it
+constexpr const double calibration_overshoot = 1.4;
+} // namespace
+
+namespace {
+thread_local std::optional<benchmark_result> last_result;
+} // namespace
+
+uint64_t benchmark_runner::measure(const std::function<void(benchmark_state&)>& proc, uint64_t num_iterations)
+{
+	ASSERT(num_iterations != 0)
+
+	benchmark_state state(num_iterations);
+	proc(state);
+
+	if (!state.start_time) {
+		throw std::logic_error("benchmark procedure did not call benchmark_state::keep_running()");
+	}
+	if (!state.finish_time) {
+		throw std::logic_error("benchmark procedure returned before benchmark_state::keep_running() returned false");
+	}
+
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(*state.finish_time - *state.start_time).count()
+	);
+}
+
+uint64_t benchmark_runner::calibrate(const std::function<void(benchmark_state&)>& proc, uint64_t target_ns)
+{
+	uint64_t n = 1;
+	for (;;) {
+		auto t = measure(proc, n);
+		if (t >= target_ns || n >= max_iterations) {
+			return n;
+		}
+
+		double multiplier = max_calibration_multiplier;
+		if (t != 0) {
+			multiplier = std::min(multiplier, calibration_overshoot * double(target_ns) / double(t));
+		}
+
+		n = std::min(std::max(n + 1, uint64_t(double(n) * multiplier)), max_iterations);
+	}
+}
+
+void benchmark_runner::run(const std::function<void(benchmark_state&)>& proc)
+{
+	ASSERT(proc)
+
+	const auto& s = settings::inst();
+
+	uint64_t target_ns = uint64_t(s.bench_time_ms) * std::nano::den / std::milli::den;
+
+	auto n = calibrate(proc, target_ns);
+
+	// warmup
+	measure(proc, n);
+
+	std::vector<double> ns_per_op;
+	ns_per_op.reserve(s.bench_repetitions);
+	for (uint32_t i = 0; i != s.bench_repetitions; ++i) {
+		ns_per_op.push_back(double(measure(proc, n)) / double(n));
+	}
+
+	benchmark_result res;
+	res.iterations = n;
+	res.repetitions = s.bench_repetitions;
+
+	double sum = 0;
+	for (auto v : ns_per_op) {
+		sum += v;
+	}
+	res.ns_per_op = sum / double(ns_per_op.size());
+
+	if (ns_per_op.size() > 1) {
+		double sum_sq = 0;
+		for (auto v : ns_per_op) {
+			sum_sq += (v - res.ns_per_op) * (v - res.ns_per_op);
+		}
+		res.stddev_ns = std::sqrt(sum_sq / double(ns_per_op.size() - 1));
+	}
+
+	last_result = res;
+}
+
+std::optional<benchmark_result> benchmark_runner::take_result()
+{
+	auto ret = last_result;
+	last_result.reset();
+	return ret;
+}
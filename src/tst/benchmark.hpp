@@ -0,0 +1,136 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include <utki/config.hpp>
+
+namespace tst {
+
+/**
+ * @brief Benchmark state.
+ * The benchmark procedure receives the state object and runs the benchmarked
+ * code in a loop while keep_running() returns true:
+ * @code
+ * suite.add_benchmark("my_benchmark", [](tst::benchmark_state& state){
+ *     // setup code, not measured
+ *     while(state.keep_running()){
+ *         // benchmarked code
+ *     }
+ * });
+ * @endcode
+ * Only the time spent in the loop is measured.
+ */
+class benchmark_state
+{
+	friend class benchmark_runner;
+
+	using clock = std::chrono::steady_clock;
+
+	uint64_t num_iterations;
+	uint64_t num_left;
+
+	std::optional<clock::time_point> start_time;
+	std::optional<clock::time_point> finish_time;
+
+	benchmark_state(uint64_t num_iterations) :
+		num_iterations(num_iterations),
+		num_left(num_iterations)
+	{}
+
+public:
+	/**
+	 * @brief Check if one more iteration has to be run.
+	 * @return true if one more iteration has to be run.
+	 * @return false if the benchmark loop has to stop.
+	 */
+	bool keep_running()
+	{
+		if (this->num_left != 0) {
+			if (this->num_left == this->num_iterations) {
+				this->start_time = clock::now();
+			}
+			--this->num_left;
+			return true;
+		}
+		this->finish_time = clock::now();
+		return false;
+	}
+
+	/**
+	 * @brief Get number of iterations the benchmark loop runs.
+	 */
+	uint64_t iterations() const noexcept
+	{
+		return this->num_iterations;
+	}
+};
+
+/**
+ * @brief Prevent compiler from optimizing away a value.
+ * Use it to make sure the result of the benchmarked code is computed.
+ * @param value - value to keep.
+ */
+template <class value_type>
+void do_not_optimize(const value_type& value)
+{
+#if CFG_COMPILER == CFG_COMPILER_MSVC
+	static_cast<void>(*static_cast<const volatile char*>(static_cast<const volatile void*>(&value)));
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+/**
+ * @brief Benchmark results.
+ */
+struct benchmark_result {
+	/**
+	 * @brief Number of iterations in one repetition.
+	 */
+	uint64_t iterations = 0;
+
+	/**
+	 * @brief Number of measured repetitions.
+	 */
+	uint32_t repetitions = 0;
+
+	/**
+	 * @brief Mean time of one iteration in nanoseconds.
+	 */
+	double ns_per_op = 0;
+
+	/**
+	 * @brief Standard deviation of time of one iteration among repetitions, in nanoseconds.
+	 */
+	double stddev_ns = 0;
+};
+
+} // namespace tst
@@ -0,0 +1,62 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <functional>
+#include <optional>
+
+#include "benchmark.hpp"
+
+namespace tst {
+
+class benchmark_runner
+{
+	// returns time of the benchmark loop in nanoseconds
+	static uint64_t measure(const std::function<void(benchmark_state&)>& proc, uint64_t num_iterations);
+
+	static uint64_t calibrate(const std::function<void(benchmark_state&)>& proc, uint64_t target_ns);
+
+public:
+	/**
+	 * @brief Run benchmark.
+	 * Calibrates number of iterations so that one repetition takes the target time,
+	 * see --bench-time, runs one warmup repetition and then the measured repetitions,
+	 * see --bench-repetitions. The results are stored for the current thread, to be
+	 * picked up with take_result().
+	 * @param proc - benchmark procedure.
+	 */
+	static void run(const std::function<void(benchmark_state&)>& proc);
+
+	/**
+	 * @brief Take results of the latest benchmark run by the current thread.
+	 * @return results of the latest benchmark.
+	 * @return empty optional if no benchmark has been run since the last call.
+	 */
+	static std::optional<benchmark_result> take_result();
+};
+
+} // namespace tst
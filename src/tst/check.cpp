@@ -26,6 +26,9 @@ SOFTWARE.
 
 #include "check.hpp"
 
+#include <array>
+#include <cstring>
+
 #include "util.hxx"
 
 using namespace tst;
@@ -34,16 +37,11 @@ namespace {
 const char* const default_fail_message = "check(false)";
 } // namespace
 
-void tst::check(
-	bool c, //
-	const std::function<void(std::ostream&)>& print,
+void tst::internal::throw_check_failure(
+	const std::function<void(std::ostream&)>& print, //
 	utki::source_location source_location
 )
 {
-	if (c) {
-		return;
-	}
-
 	std::stringstream ss;
 
 	if (print) {
@@ -55,6 +53,12 @@ void tst::check(
 	throw check_failed(ss.str(), std::move(source_location));
 }
 
+check_result::check_result(utki::source_location source_location) :
+	failed(true),
+	source_location(std::move(source_location)),
+	ss(std::make_unique<std::stringstream>())
+{}
+
 // TODO: why lint complains about it on macos?
 // "error: an exception may be thrown"
 // NOLINTNEXTLINE(bugprone-exception-escape)
@@ -66,18 +70,14 @@ check_result::check_result(check_result&& cr) noexcept :
 	cr.failed = false;
 }
 
-// TODO: remove lint suppression when
-// https://github.com/llvm/llvm-project/issues/55143 is resolved
-// NOLINTNEXTLINE(bugprone-exception-escape)
-check_result::~check_result() noexcept(false)
+void check_result::throw_failure()
 {
-	if (!this->failed) {
-		return;
-	}
+	ASSERT(this->failed)
 
 	std::string message;
 	try {
-		message = this->ss.str();
+		ASSERT(this->ss)
+		message = this->ss->str();
 		if (message.empty()) {
 			message = default_fail_message;
 		}
@@ -88,10 +88,7 @@ check_result::~check_result() noexcept(false)
 	throw check_failed(std::move(message), std::move(this->source_location));
 }
 
-check_result tst::check(
-	bool c, //
-	utki::source_location source_location
-)
+check_result check_result::make_failed(utki::source_location source_location)
 {
 #ifdef DEBUG
 	// This piece of code is just to test move constructor of check_result,
@@ -113,9 +110,291 @@ check_result tst::check(
 	}
 #endif
 
-	if (c) {
-		return {};
+	return {std::move(source_location)};
+}
+
+internal::span_mismatch internal::find_memory_mismatch(
+	const void* a, //
+	const void* b,
+	size_t size,
+	size_t element_size
+)
+{
+	// most of the elements are expected to be equal, so the equal blocks are skipped
+	// with one memcmp() call per block
+	constexpr size_t block_size_bytes = 4096;
+	const size_t block_size = std::max(size_t(1), block_size_bytes / element_size);
+
+	const auto* pa = static_cast<const uint8_t*>(a);
+	const auto* pb = static_cast<const uint8_t*>(b);
+
+	span_mismatch ret;
+
+	for (size_t block_begin = 0; block_begin < size; block_begin += block_size) {
+		auto block_end = std::min(size, block_begin + block_size);
+		if (std::memcmp(
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+				pa + block_begin * element_size,
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+				pb + block_begin * element_size,
+				(block_end - block_begin) * element_size
+			) == 0)
+		{
+			continue;
+		}
+
+		for (size_t i = block_begin; i != block_end; ++i) {
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			if (std::memcmp(pa + i * element_size, pb + i * element_size, element_size) == 0) {
+				continue;
+			}
+			if (ret.count == 0) {
+				ret.first = i;
+			}
+			++ret.count;
+		}
 	}
 
-	return {std::move(source_location)};
+	return ret;
+}
+
+namespace {
+template <class float_type>
+size_t count_not_near(const float_type* a, const float_type* b, size_t size, float_type tolerance) noexcept
+{
+	size_t ret = 0;
+	for (size_t i = 0; i != size; ++i) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		ret += size_t(!internal::is_near(a[i], b[i], tolerance));
+	}
+	return ret;
+}
+} // namespace
+
+size_t internal::count_not_near(const float* a, const float* b, size_t size, float tolerance) noexcept
+{
+	return ::count_not_near(a, b, size, tolerance);
+}
+
+size_t internal::count_not_near(const double* a, const double* b, size_t size, double tolerance) noexcept
+{
+	return ::count_not_near(a, b, size, tolerance);
+}
+
+namespace {
+template <class float_type>
+size_t count_not_ulp_near(const float_type* a, const float_type* b, size_t size, uint64_t max_ulps) noexcept
+{
+	// comparing ULP distances of the same width as the elements allows vectorization
+	using uint_type = decltype(internal::ulp_distance(float_type(), float_type()));
+	auto max = uint_type(std::min(max_ulps, uint64_t(std::numeric_limits<uint_type>::max())));
+
+	size_t ret = 0;
+	for (size_t i = 0; i != size; ++i) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		ret += size_t(!internal::is_ulp_near(a[i], b[i], max));
+	}
+	return ret;
+}
+} // namespace
+
+size_t internal::count_not_ulp_near(const float* a, const float* b, size_t size, uint64_t max_ulps) noexcept
+{
+	return ::count_not_ulp_near(a, b, size, max_ulps);
+}
+
+size_t internal::count_not_ulp_near(const double* a, const double* b, size_t size, uint64_t max_ulps) noexcept
+{
+	return ::count_not_ulp_near(a, b, size, max_ulps);
+}
+
+namespace {
+// Builds failure message for comparison of floating point spans.
+// The is_near function tells if the elements are near, same as used by the vectorized kernels.
+// The error function returns error of the elements to be compared to the tolerance.
+// The zero_tolerance_scale is used as unit of the error histogram in case the tolerance is 0.
+template <class float_type, class is_near_type, class error_type>
+std::string make_float_mismatch_message(
+	std::string_view name,
+	utki::span<const float_type> a,
+	utki::span<const float_type> b,
+	double tolerance,
+	double zero_tolerance_scale,
+	const is_near_type& is_near,
+	const error_type& error
+)
+{
+	std::stringstream ss;
+	ss << std::setprecision(std::numeric_limits<float_type>::max_digits10);
+	ss << name << "(span[" << a.size() << "], span[" << b.size() << "], " << tolerance << ")";
+
+	if (a.size() != b.size()) {
+		ss << ": sizes differ";
+	}
+
+	// histogram of errors in multiples of tolerance, by decades,
+	// with zero tolerance every error would be infinitely many tolerances,
+	// so the errors are measured in units of the fallback scale then
+	bool is_zero_tolerance = !(tolerance > 0);
+	double scale = is_zero_tolerance ? zero_tolerance_scale : tolerance;
+	std::array<std::string_view, 5> bucket_names = {
+		is_zero_tolerance ? "(0, 10]" : "(1, 10]", //
+		"(10, 100]",
+		"(100, 1000]",
+		"(1000, 10000]",
+		"> 10000"
+	};
+	std::array<size_t, bucket_names.size()> histogram{};
+	size_t num_nans = 0;
+
+	size_t count = 0;
+	size_t max_error_index = 0;
+	double max_error = -1;
+
+	auto size = std::min(a.size(), b.size());
+	for (size_t i = 0; i != size; ++i) {
+		if (is_near(a[i], b[i])) {
+			continue;
+		}
+		++count;
+
+		if (std::isnan(a[i]) || std::isnan(b[i])) {
+			if (num_nans == 0 && max_error < 0) {
+				max_error_index = i;
+			}
+			++num_nans;
+			continue;
+		}
+
+		double e = error(a[i], b[i]);
+		if (e > max_error) {
+			max_error = e;
+			max_error_index = i;
+		}
+
+		size_t bucket = 0;
+		constexpr auto decade = 10;
+		for (double limit = scale * decade; bucket != histogram.size() - 1 && !(e <= limit); limit *= decade) {
+			++bucket;
+		}
+		++histogram[bucket];
+	}
+
+	if (count == 0) {
+		return ss.str();
+	}
+
+	ss << (a.size() != b.size() ? ", " : ": ");
+	ss << count << " element(s) out of tolerance, ";
+	if (max_error < 0) {
+		ss << "first NaN";
+	} else {
+		ss << "max error " << max_error;
+	}
+	ss << " at index " << max_error_index << ": a = " << a[max_error_index] << ", b = " << b[max_error_index];
+
+	if (is_zero_tolerance) {
+		ss << '\n' << "  error / " << scale << " histogram:";
+	} else {
+		ss << '\n' << "  error / tolerance histogram:";
+	}
+	for (size_t i = 0; i != histogram.size(); ++i) {
+		if (histogram[i] != 0) {
+			ss << '\n' << "    " << bucket_names[i] << ": " << histogram[i];
+		}
+	}
+	if (num_nans != 0) {
+		ss << '\n' << "    NaN: " << num_nans;
+	}
+	ss << '\n';
+
+	return ss.str();
+}
+} // namespace
+
+namespace {
+template <class float_type>
+std::string make_near_mismatch_message(
+	utki::span<const float_type> a, //
+	utki::span<const float_type> b,
+	float_type tolerance
+)
+{
+	return make_float_mismatch_message(
+		"check_near",
+		a,
+		b,
+		double(tolerance),
+		// relative error is not measurable finer than the machine epsilon
+		double(std::numeric_limits<float_type>::epsilon()),
+		[tolerance](float_type a, float_type b) {
+			return internal::is_near(a, b, tolerance);
+		},
+		[](float_type a, float_type b) {
+			// relative error for values greater than 1 by magnitude, absolute error otherwise
+			auto scale = std::max(std::max(1.0, std::abs(double(a))), std::abs(double(b)));
+			return std::abs(double(a) - double(b)) / scale;
+		}
+	);
+}
+} // namespace
+
+std::string internal::make_near_mismatch_message(
+	utki::span<const float> a, //
+	utki::span<const float> b,
+	float tolerance
+)
+{
+	return ::make_near_mismatch_message(a, b, tolerance);
+}
+
+std::string internal::make_near_mismatch_message(
+	utki::span<const double> a, //
+	utki::span<const double> b,
+	double tolerance
+)
+{
+	return ::make_near_mismatch_message(a, b, tolerance);
+}
+
+namespace {
+template <class float_type>
+std::string make_ulp_mismatch_message(
+	utki::span<const float_type> a, //
+	utki::span<const float_type> b,
+	uint64_t max_ulps
+)
+{
+	return make_float_mismatch_message(
+		"check_ulp",
+		a,
+		b,
+		double(max_ulps),
+		1, // one ULP
+		[max_ulps](float_type a, float_type b) {
+			return internal::is_ulp_near(a, b, max_ulps);
+		},
+		[](float_type a, float_type b) {
+			return double(internal::ulp_distance(a, b));
+		}
+	);
+}
+} // namespace
+
+std::string internal::make_ulp_mismatch_message(
+	utki::span<const float> a, //
+	utki::span<const float> b,
+	uint64_t max_ulps
+)
+{
+	return ::make_ulp_mismatch_message(a, b, max_ulps);
+}
+
+std::string internal::make_ulp_mismatch_message(
+	utki::span<const double> a, //
+	utki::span<const double> b,
+	uint64_t max_ulps
+)
+{
+	return ::make_ulp_mismatch_message(a, b, max_ulps);
 }
@@ -26,15 +26,34 @@ SOFTWARE.
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <utki/debug.hpp>
+#include <utki/span.hpp>
 
 namespace tst {
 
+namespace internal {
+// Failure path of the checks is kept out of line, so that a passing check is just a branch.
+[[noreturn]] void throw_check_failure(
+	const std::function<void(std::ostream&)>& print, //
+	utki::source_location source_location
+);
+} // namespace internal
+
 /**
  * @brief Check for condition with additional failure information.
  * The function checks for the condition to be true.
@@ -47,14 +66,20 @@ namespace tst {
  * information.
  * @param source_location - object with source file:line information.
  */
-void check(
+inline void check(
 	bool c, //
 	const std::function<void(std::ostream&)>& print,
 	utki::source_location source_location
 #if CFG_CPP >= 20
 	= utki::std_source_location::current()
 #endif
-);
+)
+{
+	if (c) {
+		return;
+	}
+	internal::throw_check_failure(print, std::move(source_location));
+}
 
 /**
  * @brief Template check() function for any type convertible to bool.
@@ -82,6 +107,35 @@ void check(
 	);
 }
 
+/**
+ * @brief Check for condition with additional failure information.
+ * Same as check(bool, print, source_location), but the print function is taken
+ * as is. It is only converted to std::function in case the check fails, so
+ * passing a lambda does not cost anything when the check passes.
+ * @param p - value to convert to boolean and check for true-value.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <
+	class check_type,
+	class print_type,
+	std::enable_if_t<std::is_invocable_v<print_type&, std::ostream&>, bool> = true>
+void check(
+	const check_type& p, //
+	print_type&& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (static_cast<bool>(p)) {
+		return;
+	}
+	internal::throw_check_failure(std::forward<print_type>(print), std::move(source_location));
+}
+
 /**
  * @brief Check result.
  * The object of this class is returned from check() functions which do not
@@ -96,14 +150,17 @@ class check_result
 
 	bool failed = false;
 	utki::source_location source_location;
-	std::stringstream ss;
+
+	// the string stream is only created for failed check
+	std::unique_ptr<std::stringstream> ss;
 
 	check_result() = default;
 
-	check_result(utki::source_location source_location) :
-		failed(true),
-		source_location(std::move(source_location))
-	{}
+	check_result(utki::source_location source_location);
+
+	static check_result make_failed(utki::source_location source_location);
+
+	[[noreturn]] void throw_failure();
 
 public:
 	check_result(const check_result&) = delete;
@@ -125,8 +182,9 @@ public:
 	check_result& operator<<(const object_type& v)
 	{
 		if (this->failed) {
+			ASSERT(this->ss)
 			// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
-			this->ss << v;
+			*this->ss << v;
 		}
 		return *this;
 	}
@@ -134,7 +192,12 @@ public:
 	// TODO: remove lint suppression when
 	// https://github.com/llvm/llvm-project/issues/55143 is resolved
 	// NOLINTNEXTLINE(bugprone-exception-escape)
-	~check_result() noexcept(false);
+	~check_result() noexcept(false)
+	{
+		if (this->failed) {
+			this->throw_failure();
+		}
+	}
 };
 
 /**
@@ -144,13 +207,19 @@ public:
  * @param source_location - object with source file:line information.
  * @return an instance of check_result.
  */
-check_result check(
+inline check_result check(
 	bool c,
 	utki::source_location source_location
 #if CFG_CPP >= 20
 	= utki::std_source_location::current()
 #endif
-);
+)
+{
+	if (c) {
+		return {};
+	}
+	return check_result::make_failed(std::move(source_location));
+}
 
 /**
  * @brief Template check() function for any type convertible to bool.
@@ -196,8 +265,11 @@ void check_eq(
 #endif
 )
 {
+	if (a == b) {
+		return;
+	}
 	check(
-		a == b,
+		false,
 		[&](auto& o) {
 			o << "check_eq(" << a << ", " << b << ")";
 			if (print) {
@@ -227,7 +299,10 @@ check_result check_eq(
 #endif
 )
 {
-	auto ret = check(a == b, std::move(source_location));
+	if (a == b) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
 	ret << "check_eq(" << a << ", " << b << ")";
 	return ret;
 }
@@ -254,8 +329,11 @@ void check_ne(
 #endif
 )
 {
+	if (a != b) {
+		return;
+	}
 	check(
-		a != b,
+		false,
 		[&](auto& o) {
 			o << "check_ne(" << a << ", " << b << ")";
 			if (print) {
@@ -285,7 +363,10 @@ check_result check_ne(
 #endif
 )
 {
-	auto ret = check(a != b, std::move(source_location));
+	if (a != b) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
 	ret << "check_ne(" << a << ", " << b << ")";
 	return ret;
 }
@@ -312,8 +393,11 @@ void check_lt(
 #endif
 )
 {
+	if (a < b) {
+		return;
+	}
 	check(
-		a < b,
+		false,
 		[&](auto& o) {
 			o << "check_lt(" << a << ", " << b << ")";
 			if (print) {
@@ -343,7 +427,10 @@ check_result check_lt(
 #endif
 )
 {
-	auto ret = check(a < b, std::move(source_location));
+	if (a < b) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
 	ret << "check_lt(" << a << ", " << b << ")";
 	return ret;
 }
@@ -370,8 +457,11 @@ void check_gt(
 #endif
 )
 {
+	if (a > b) {
+		return;
+	}
 	check(
-		a > b,
+		false,
 		[&](auto& o) {
 			o << "check_gt(" << a << ", " << b << ")";
 			if (print) {
@@ -401,7 +491,10 @@ check_result check_gt(
 #endif
 )
 {
-	auto ret = check(a > b, std::move(source_location));
+	if (a > b) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
 	ret << "check_gt(" << a << ", " << b << ")";
 	return ret;
 }
@@ -428,8 +521,11 @@ void check_le(
 #endif
 )
 {
+	if (a <= b) {
+		return;
+	}
 	check(
-		a <= b,
+		false,
 		[&](auto& o) {
 			o << "check_le(" << a << ", " << b << ")";
 			if (print) {
@@ -459,10 +555,10 @@ check_result check_le(
 #endif
 )
 {
-	auto ret = check(
-		a <= b, //
-		std::move(source_location)
-	);
+	if (a <= b) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
 	ret << "check_le(" << a << ", " << b << ")";
 	return ret;
 }
@@ -489,8 +585,11 @@ void check_ge(
 #endif
 )
 {
+	if (a >= b) {
+		return;
+	}
 	check(
-		a >= b, //
+		false,
 		[&](auto& o) {
 			o << "check_ge(" << a << ", " << b << ")";
 			if (print) {
@@ -520,12 +619,747 @@ check_result check_ge(
 #endif
 )
 {
-	auto ret = check(
-		a >= b, //
+	if (a >= b) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
+	ret << "check_ge(" << a << ", " << b << ")";
+	return ret;
+}
+
+namespace internal {
+template <class element_type>
+constexpr bool is_bytewise_comparable_v = //
+	std::is_integral_v<element_type> || //
+	std::is_enum_v<element_type> || //
+	std::is_pointer_v<element_type>;
+
+// std::vector<bool> packs its elements into bits, so it has no contiguous array of elements
+template <class container_type>
+constexpr bool is_contiguous_bytewise_comparable_v = //
+	is_bytewise_comparable_v<typename container_type::value_type> &&
+	!std::is_same_v<container_type, std::vector<bool>>;
+
+struct span_mismatch {
+	// index of the first differing element
+	size_t first = 0;
+
+	// number of differing elements
+	size_t count = 0;
+};
+
+// Compares arrays of elements which are equal if and only if their bytes are equal.
+// The arrays are compared by blocks with memcmp(), which is vectorized by the C library.
+span_mismatch find_memory_mismatch(const void* a, const void* b, size_t size, size_t element_size);
+
+template <class element_type>
+bool is_span_equal(utki::span<const element_type> a, utki::span<const element_type> b)
+{
+	if (a.size() != b.size()) {
+		return false;
+	}
+	if (a.empty()) {
+		return true;
+	}
+	if constexpr (is_bytewise_comparable_v<element_type>) {
+		return std::memcmp(a.data(), b.data(), a.size() * sizeof(element_type)) == 0;
+	} else {
+		return std::equal(a.begin(), a.end(), b.begin());
+	}
+}
+
+template <class container_type>
+span_mismatch find_span_mismatch(const container_type& a, const container_type& b)
+{
+	auto size = std::min(a.size(), b.size());
+
+	if constexpr (is_contiguous_bytewise_comparable_v<container_type>) {
+		return find_memory_mismatch(a.data(), b.data(), size, sizeof(typename container_type::value_type));
+	} else {
+		span_mismatch ret;
+		for (size_t i = 0; i != size; ++i) {
+			if (a[i] == b[i]) {
+				continue;
+			}
+			if (ret.count == 0) {
+				ret.first = i;
+			}
+			++ret.count;
+		}
+		return ret;
+	}
+}
+
+template <class container_type>
+void print_span_elements(std::ostream& o, const container_type& s, size_t begin, size_t end)
+{
+	using element_type = typename container_type::value_type;
+	o << '[' << begin << ", " << end << "):";
+	for (size_t i = begin; i != end; ++i) {
+		o << ' ';
+		if constexpr (sizeof(element_type) == 1 && is_bytewise_comparable_v<element_type>) {
+			// bytes are printed in hex
+			constexpr auto hex_digits = "0123456789abcdef";
+			constexpr auto nibble_bits = 4;
+			constexpr auto nibble_mask = 0xf;
+			auto byte = unsigned(static_cast<uint8_t>(s[i]));
+			o << hex_digits[byte >> nibble_bits] << hex_digits[byte & nibble_mask];
+		} else {
+			o << s[i];
+		}
+	}
+}
+
+template <class container_type>
+std::string make_span_mismatch_message(const container_type& a, const container_type& b)
+{
+	std::stringstream ss;
+	ss << "check_eq(span[" << a.size() << "], span[" << b.size() << "])";
+
+	if (a.size() != b.size()) {
+		ss << ": sizes differ";
+	}
+
+	auto m = find_span_mismatch(a, b);
+	if (m.count == 0) {
+		return ss.str();
+	}
+
+	ss << (a.size() != b.size() ? ", " : ": ");
+	ss << m.count << " element(s) differ, first mismatch at index " << m.first;
+
+	// number of elements printed before and after the first mismatch
+	constexpr size_t context_size = 8;
+	auto begin = m.first - std::min(m.first, context_size);
+
+	ss << '\n' << "  a";
+	print_span_elements(ss, a, begin, std::min(a.size(), m.first + context_size + 1));
+	ss << '\n' << "  b";
+	print_span_elements(ss, b, begin, std::min(b.size(), m.first + context_size + 1));
+	ss << '\n';
+
+	return ss.str();
+}
+} // namespace internal
+
+/**
+ * @brief Check for equality of two spans.
+ * The spans are equal in case they have same size and all their elements are equal.
+ * Spans of integral, enum or pointer elements are compared bytewise with
+ * vectorized memory comparison. In case of check failure, the failure message
+ * contains the index of the first mismatch, the elements around it and the
+ * total number of differing elements. Bytes are printed in hex.
+ * @param a - fisrt span.
+ * @param b - second span.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class element_type>
+void check_eq(
+	utki::span<element_type> a, //
+	utki::span<element_type> b,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	using const_span = utki::span<const element_type>;
+	if (internal::is_span_equal(const_span(a), const_span(b))) {
+		return;
+	}
+	check(
+		false,
+		[&](auto& o) {
+			o << internal::make_span_mismatch_message(const_span(a), const_span(b));
+			if (print) {
+				print(o);
+			}
+		},
 		std::move(source_location)
 	);
-	ret << "check_ge(" << a << ", " << b << ")";
+}
+
+/**
+ * @brief Check for equality of two spans.
+ * The spans are equal in case they have same size and all their elements are equal.
+ * Spans of integral, enum or pointer elements are compared bytewise with
+ * vectorized memory comparison. In case of check failure, the failure message
+ * contains the index of the first mismatch, the elements around it and the
+ * total number of differing elements. Bytes are printed in hex.
+ * @param a - fisrt span.
+ * @param b - second span.
+ * @param source_location - object with source file:line information.
+ */
+template <class element_type>
+check_result check_eq(
+	utki::span<element_type> a, //
+	utki::span<element_type> b,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	using const_span = utki::span<const element_type>;
+	if (internal::is_span_equal(const_span(a), const_span(b))) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
+	ret << internal::make_span_mismatch_message(const_span(a), const_span(b));
+	return ret;
+}
+
+/**
+ * @brief Check for equality of two vectors.
+ * Same as check_eq() for spans.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class element_type, std::enable_if_t<!std::is_same_v<element_type, bool>, bool> = true>
+void check_eq(
+	const std::vector<element_type>& a, //
+	const std::vector<element_type>& b,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	check_eq(utki::make_span(a), utki::make_span(b), print, std::move(source_location));
+}
+
+/**
+ * @brief Check for equality of two vectors.
+ * Same as check_eq() for spans.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param source_location - object with source file:line information.
+ */
+template <class element_type, std::enable_if_t<!std::is_same_v<element_type, bool>, bool> = true>
+check_result check_eq(
+	const std::vector<element_type>& a, //
+	const std::vector<element_type>& b,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	return check_eq(utki::make_span(a), utki::make_span(b), std::move(source_location));
+}
+
+/**
+ * @brief Check for equality of two bool vectors.
+ * std::vector<bool> stores its elements as bits, so the vectors are compared
+ * element by element. The failure message is same as for check_eq() for spans.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+inline void check_eq(
+	const std::vector<bool>& a, //
+	const std::vector<bool>& b,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (a == b) {
+		return;
+	}
+	check(
+		false,
+		[&](auto& o) {
+			o << internal::make_span_mismatch_message(a, b);
+			if (print) {
+				print(o);
+			}
+		},
+		std::move(source_location)
+	);
+}
+
+/**
+ * @brief Check for equality of two bool vectors.
+ * Same as check_eq() for bool vectors with print function.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param source_location - object with source file:line information.
+ */
+inline check_result check_eq(
+	const std::vector<bool>& a, //
+	const std::vector<bool>& b,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (a == b) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
+	ret << internal::make_span_mismatch_message(a, b);
+	return ret;
+}
+
+namespace internal {
+// Maps bits of a floating point number to a signed integer, so that the integers
+// are ordered same way as the floating point numbers. Distance between the
+// integers is the number of ULPs between the floating point numbers.
+template <class float_type>
+auto to_ordered_int(float_type f) noexcept
+{
+	static_assert(
+		std::is_same_v<float_type, float> || std::is_same_v<float_type, double>,
+		"only float and double are supported"
+	);
+	using int_type = std::conditional_t<sizeof(float_type) == sizeof(int32_t), int32_t, int64_t>;
+	static_assert(sizeof(int_type) == sizeof(float_type));
+
+	int_type i = 0;
+	std::memcpy(&i, &f, sizeof(f));
+
+	// floating point numbers use sign-magnitude representation
+	return i < 0 ? std::numeric_limits<int_type>::min() - i : i;
+}
+
+template <class float_type>
+auto ulp_distance(float_type a, float_type b) noexcept
+{
+	auto ia = to_ordered_int(a);
+	auto ib = to_ordered_int(b);
+	using uint_type = std::make_unsigned_t<decltype(ia)>;
+	return ia < ib ? uint_type(uint_type(ib) - uint_type(ia)) : uint_type(uint_type(ia) - uint_type(ib));
+}
+
+template <class float_type>
+bool is_near(float_type a, float_type b, float_type tolerance) noexcept
+{
+	auto scale = std::max(std::max(float_type(1), std::abs(a)), std::abs(b));
+	// non-short-circuit operators allow vectorization of loops
+	return (a == b) | (std::abs(a - b) <= tolerance * scale);
+}
+
+template <class float_type, class max_ulps_type>
+bool is_ulp_near(float_type a, float_type b, max_ulps_type max_ulps) noexcept
+{
+	// NaN is never near anything
+	// NOLINTNEXTLINE(misc-redundant-expression)
+	return (a == a) & (b == b) & (ulp_distance(a, b) <= max_ulps);
+}
+
+// Vectorizable kernels, return number of element pairs which are not near.
+size_t count_not_near(const float* a, const float* b, size_t size, float tolerance) noexcept;
+size_t count_not_near(const double* a, const double* b, size_t size, double tolerance) noexcept;
+size_t count_not_ulp_near(const float* a, const float* b, size_t size, uint64_t max_ulps) noexcept;
+size_t count_not_ulp_near(const double* a, const double* b, size_t size, uint64_t max_ulps) noexcept;
+
+std::string make_near_mismatch_message(utki::span<const float> a, utki::span<const float> b, float tolerance);
+std::string make_near_mismatch_message(utki::span<const double> a, utki::span<const double> b, double tolerance);
+std::string make_ulp_mismatch_message(utki::span<const float> a, utki::span<const float> b, uint64_t max_ulps);
+std::string make_ulp_mismatch_message(utki::span<const double> a, utki::span<const double> b, uint64_t max_ulps);
+} // namespace internal
+
+/**
+ * @brief Check for approximate equality of floating point values.
+ * The values are near in case |a - b| <= tolerance * max(1, |a|, |b|), i.e.
+ * the tolerance is relative for values greater than 1 by magnitude and
+ * absolute for smaller values. NaN is never near anything.
+ * @param a - fisrt value.
+ * @param b - second value.
+ * @param tolerance - the tolerance.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+check_result check_near(
+	float_type a, //
+	float_type b,
+	std::remove_const_t<float_type> tolerance,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	static_assert(std::is_floating_point_v<float_type>, "check_near() is only for floating point values");
+	if (internal::is_near(a, b, tolerance)) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
+	ret << std::setprecision(std::numeric_limits<float_type>::max_digits10);
+	ret << "check_near(" << a << ", " << b << ", " << tolerance << ")";
+	return ret;
+}
+
+/**
+ * @brief Check for approximate equality of floating point values.
+ * Same as check_near(), but the additional failure message information
+ * is output by the print function.
+ * @param a - fisrt value.
+ * @param b - second value.
+ * @param tolerance - the tolerance.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+void check_near(
+	float_type a, //
+	float_type b,
+	std::remove_const_t<float_type> tolerance,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	static_assert(std::is_floating_point_v<float_type>, "check_near() is only for floating point values");
+	if (internal::is_near(a, b, tolerance)) {
+		return;
+	}
+	check(
+		false,
+		[&](auto& o) {
+			o << std::setprecision(std::numeric_limits<float_type>::max_digits10);
+			o << "check_near(" << a << ", " << b << ", " << tolerance << ")";
+			if (print) {
+				print(o);
+			}
+		},
+		std::move(source_location)
+	);
+}
+
+/**
+ * @brief Check for approximate equality of floating point spans.
+ * The spans are near in case they have same size and all their elements are
+ * near, see check_near() for values. The elements are compared with a
+ * vectorized loop. In case of check failure, the failure message contains
+ * the number of elements out of tolerance, the maximal error along with its
+ * index and the histogram of errors.
+ * @param a - fisrt span.
+ * @param b - second span.
+ * @param tolerance - the tolerance.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+check_result check_near(
+	utki::span<float_type> a, //
+	utki::span<float_type> b,
+	std::remove_const_t<float_type> tolerance,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (a.size() == b.size() && internal::count_not_near(a.data(), b.data(), a.size(), tolerance) == 0) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
+	ret << internal::make_near_mismatch_message(
+		utki::span<const float_type>(a), //
+		utki::span<const float_type>(b),
+		tolerance
+	);
 	return ret;
 }
 
+/**
+ * @brief Check for approximate equality of floating point spans.
+ * Same as check_near() for spans, but the additional failure message information
+ * is output by the print function.
+ * @param a - fisrt span.
+ * @param b - second span.
+ * @param tolerance - the tolerance.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+void check_near(
+	utki::span<float_type> a, //
+	utki::span<float_type> b,
+	std::remove_const_t<float_type> tolerance,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (a.size() == b.size() && internal::count_not_near(a.data(), b.data(), a.size(), tolerance) == 0) {
+		return;
+	}
+	check(
+		false,
+		[&](auto& o) {
+			o << internal::make_near_mismatch_message(
+				utki::span<const float_type>(a), //
+				utki::span<const float_type>(b),
+				tolerance
+			);
+			if (print) {
+				print(o);
+			}
+		},
+		std::move(source_location)
+	);
+}
+
+/**
+ * @brief Check for approximate equality of floating point vectors.
+ * Same as check_near() for spans.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param tolerance - the tolerance.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+check_result check_near(
+	const std::vector<float_type>& a, //
+	const std::vector<float_type>& b,
+	std::remove_const_t<float_type> tolerance,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	return check_near(utki::make_span(a), utki::make_span(b), tolerance, std::move(source_location));
+}
+
+/**
+ * @brief Check for approximate equality of floating point vectors.
+ * Same as check_near() for spans.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param tolerance - the tolerance.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+void check_near(
+	const std::vector<float_type>& a, //
+	const std::vector<float_type>& b,
+	std::remove_const_t<float_type> tolerance,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	check_near(utki::make_span(a), utki::make_span(b), tolerance, print, std::move(source_location));
+}
+
+/**
+ * @brief Check for floating point values being within given number of ULPs.
+ * ULP is the unit in the last place, i.e. the distance between two adjacent
+ * floating point numbers. Positive and negative zeros are equal. NaN is never
+ * near anything.
+ * @param a - fisrt value.
+ * @param b - second value.
+ * @param max_ulps - maximal allowed distance between the values in ULPs.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+check_result check_ulp(
+	float_type a, //
+	float_type b,
+	uint64_t max_ulps,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (internal::is_ulp_near(a, b, max_ulps)) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
+	ret << std::setprecision(std::numeric_limits<float_type>::max_digits10);
+	ret << "check_ulp(" << a << ", " << b << ", " << max_ulps << "): " << internal::ulp_distance(a, b)
+		<< " ULP(s) apart";
+	return ret;
+}
+
+/**
+ * @brief Check for floating point values being within given number of ULPs.
+ * Same as check_ulp(), but the additional failure message information
+ * is output by the print function.
+ * @param a - fisrt value.
+ * @param b - second value.
+ * @param max_ulps - maximal allowed distance between the values in ULPs.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+void check_ulp(
+	float_type a, //
+	float_type b,
+	uint64_t max_ulps,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (internal::is_ulp_near(a, b, max_ulps)) {
+		return;
+	}
+	check(
+		false,
+		[&](auto& o) {
+			o << std::setprecision(std::numeric_limits<float_type>::max_digits10);
+			o << "check_ulp(" << a << ", " << b << ", " << max_ulps << "): " << internal::ulp_distance(a, b)
+			  << " ULP(s) apart";
+			if (print) {
+				print(o);
+			}
+		},
+		std::move(source_location)
+	);
+}
+
+/**
+ * @brief Check for floating point spans being within given number of ULPs.
+ * The spans are near in case they have same size and all their elements are
+ * within given number of ULPs, see check_ulp() for values. The elements are
+ * compared with a vectorized loop. In case of check failure, the failure
+ * message contains the number of elements out of tolerance, the maximal error
+ * along with its index and the histogram of errors.
+ * @param a - fisrt span.
+ * @param b - second span.
+ * @param max_ulps - maximal allowed distance between the elements in ULPs.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+check_result check_ulp(
+	utki::span<float_type> a, //
+	utki::span<float_type> b,
+	uint64_t max_ulps,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (a.size() == b.size() && internal::count_not_ulp_near(a.data(), b.data(), a.size(), max_ulps) == 0) {
+		return check(true, std::move(source_location));
+	}
+	auto ret = check(false, std::move(source_location));
+	ret << internal::make_ulp_mismatch_message(
+		utki::span<const float_type>(a), //
+		utki::span<const float_type>(b),
+		max_ulps
+	);
+	return ret;
+}
+
+/**
+ * @brief Check for floating point spans being within given number of ULPs.
+ * Same as check_ulp() for spans, but the additional failure message information
+ * is output by the print function.
+ * @param a - fisrt span.
+ * @param b - second span.
+ * @param max_ulps - maximal allowed distance between the elements in ULPs.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+void check_ulp(
+	utki::span<float_type> a, //
+	utki::span<float_type> b,
+	uint64_t max_ulps,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	if (a.size() == b.size() && internal::count_not_ulp_near(a.data(), b.data(), a.size(), max_ulps) == 0) {
+		return;
+	}
+	check(
+		false,
+		[&](auto& o) {
+			o << internal::make_ulp_mismatch_message(
+				utki::span<const float_type>(a), //
+				utki::span<const float_type>(b),
+				max_ulps
+			);
+			if (print) {
+				print(o);
+			}
+		},
+		std::move(source_location)
+	);
+}
+
+/**
+ * @brief Check for floating point vectors being within given number of ULPs.
+ * Same as check_ulp() for spans.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param max_ulps - maximal allowed distance between the elements in ULPs.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+check_result check_ulp(
+	const std::vector<float_type>& a, //
+	const std::vector<float_type>& b,
+	uint64_t max_ulps,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	return check_ulp(utki::make_span(a), utki::make_span(b), max_ulps, std::move(source_location));
+}
+
+/**
+ * @brief Check for floating point vectors being within given number of ULPs.
+ * Same as check_ulp() for spans.
+ * @param a - fisrt vector.
+ * @param b - second vector.
+ * @param max_ulps - maximal allowed distance between the elements in ULPs.
+ * @param print - function performing output of addional failure message
+ * information.
+ * @param source_location - object with source file:line information.
+ */
+template <class float_type>
+void check_ulp(
+	const std::vector<float_type>& a, //
+	const std::vector<float_type>& b,
+	uint64_t max_ulps,
+	const std::function<void(std::ostream&)>& print,
+	utki::source_location source_location
+#if CFG_CPP >= 20
+	= utki::std_source_location::current()
+#endif
+)
+{
+	check_ulp(utki::make_span(a), utki::make_span(b), max_ulps, print, std::move(source_location));
+}
+
 } // namespace tst
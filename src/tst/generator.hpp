@@ -0,0 +1,154 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include <utki/debug.hpp>
+
+namespace tst {
+
+/**
+ * @brief Lazy generator of test procedure parameters.
+ * The generator produces parameters by their indices on demand, so the
+ * parameters do not have to be all in memory at the same time. For parametrized
+ * test case added with a generator, the parameter is generated right before the
+ * test procedure is called and is destroyed right after that.
+ * @code
+ * tst::generator<std::string> strings(100'000, [](size_t i){
+ *     return std::to_string(i);
+ * });
+ * @endcode
+ * Note, that parametrized tests can run in parallel, so the generator function
+ * can be called from several threads at the same time.
+ */
+template <class parameter_type>
+class generator
+{
+	size_t num_params;
+	std::function<parameter_type(size_t)> gen;
+
+public:
+	using value_type = parameter_type;
+
+	/**
+	 * @brief Constructor.
+	 * @param size - number of parameters the generator produces.
+	 * @param gen - function which produces the parameter by its index.
+	 *              The index is within [0, size).
+	 * @throw std::invalid_argument - in case the generator function is nullptr.
+	 */
+	generator(size_t size, std::function<parameter_type(size_t index)> gen) :
+		num_params(size),
+		gen(std::move(gen))
+	{
+		if (!this->gen) {
+			throw std::invalid_argument("generator function is nullptr");
+		}
+	}
+
+	/**
+	 * @brief Get number of parameters.
+	 * @return number of parameters the generator produces.
+	 */
+	size_t size() const noexcept
+	{
+		return this->num_params;
+	}
+
+	/**
+	 * @brief Generate parameter.
+	 * @param index - index of the parameter to generate.
+	 * @return the generated parameter.
+	 */
+	parameter_type operator[](size_t index) const
+	{
+		ASSERT(index < this->num_params)
+		return this->gen(index);
+	}
+};
+
+namespace internal {
+template <class... parameter_types, size_t... i>
+std::tuple<parameter_types...> make_cartesian_parameter(
+	const std::tuple<generator<parameter_types>...>& gens,
+	size_t index,
+	std::index_sequence<i...> /* indices */
+)
+{
+	constexpr auto num_gens = sizeof...(parameter_types);
+
+	std::array<size_t, num_gens> sizes = {std::get<i>(gens).size()...};
+
+	// the last generator's index changes fastest
+	std::array<size_t, num_gens> indices{};
+	for (size_t k = num_gens; k != 0; --k) {
+		indices[k - 1] = index % sizes[k - 1];
+		index /= sizes[k - 1];
+	}
+
+	return std::tuple<parameter_types...>(std::get<i>(gens)[indices[i]]...);
+}
+} // namespace internal
+
+/**
+ * @brief Cartesian product of generators.
+ * Creates a generator of tuples of all combinations of the parameters produced
+ * by the given generators. The parameters of the last generator change
+ * fastest. The parameters are generated on demand, same as for the given
+ * generators.
+ * @param gens - generators to combine.
+ * @return generator of parameter tuples.
+ * @throw std::invalid_argument - in case the number of combinations does not fit into size_t.
+ */
+template <class... parameter_types>
+generator<std::tuple<parameter_types...>> cartesian(generator<parameter_types>... gens)
+{
+	static_assert(sizeof...(parameter_types) != 0, "at least one generator is required");
+
+	size_t size = 1;
+	for (auto s : {gens.size()...}) {
+		if (s != 0 && size > std::numeric_limits<size_t>::max() / s) {
+			throw std::invalid_argument("cartesian product of generators is too big");
+		}
+		size *= s;
+	}
+
+	return generator<std::tuple<parameter_types...>>(
+		size,
+		[gens = std::make_tuple(std::move(gens)...)](size_t index) {
+			return internal::make_cartesian_parameter(gens, index, std::index_sequence_for<parameter_types...>());
+		}
+	);
+}
+
+} // namespace tst
@@ -31,57 +31,64 @@ SOFTWARE.
 
 namespace tst {
 
+// Iterates over the test table of the application.
 class iterator
 {
-	const decltype(application::suites)& suites;
+	const decltype(application::test_table)* table;
 
-	decltype(application::suites)::const_iterator si;
-	decltype(suite::tests)::const_iterator pi;
+	size_t i = 0;
 
-	void init_pi()
+public:
+	iterator(const application& app, size_t index = 0) :
+		table(&app.test_table),
+		i(index)
+	{}
+
+	bool is_valid() const
 	{
-		for (; this->si != this->suites.end(); ++this->si) {
-			if (!this->si->second.tests.empty()) {
-				this->pi = this->si->second.tests.begin();
-				return;
-			}
-		}
+		return this->i != this->table->size();
 	}
 
-public:
-	iterator(decltype(suites)& suites) :
-		suites(suites),
-		si(suites.begin())
+	void next()
 	{
-		this->init_pi();
+		ASSERT(this->is_valid())
+		++this->i;
 	}
 
-	bool is_valid() const
+	// integer id of the test
+	size_t index() const noexcept
 	{
-		return this->si != this->suites.end();
+		return this->i;
 	}
 
-	void next()
+	const suite::test_info& info() const
 	{
 		ASSERT(this->is_valid())
-		++this->pi;
-		if (this->pi == this->si->second.tests.end()) {
-			++this->si;
-			this->init_pi();
-		}
+		return *(*this->table)[this->i].info;
 	}
 
-	const suite::test_info& info() const
+	const suite::test_result& result() const
 	{
 		ASSERT(this->is_valid())
-		return this->pi->second;
+		return (*this->table)[this->i].result;
 	}
 
+	// the id of a parametrized test case is composed on each call
 	full_id id() const
 	{
 		ASSERT(this->is_valid())
-		// NOLINTNEXTLINE(modernize-use-designated-initializers)
-		return {this->si->first, this->pi->first};
+		const auto& r = (*this->table)[this->i];
+		if (!r.info->is_parametrized) {
+			return full_id(*r.suite, r.info->id);
+		}
+		return full_id(*r.suite, suite::make_indexed_id(r.info->id, r.param_index));
+	}
+
+	void run() const
+	{
+		ASSERT(this->is_valid())
+		const auto& r = (*this->table)[this->i];
+		r.info->run(r.param_index);
 	}
 };
 
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "junit_stream.hxx"
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace tst;
+
+namespace {
+constexpr std::string_view root_tag_name = "<testsuites";
+constexpr std::string_view root_end_tag = "</testsuites>\n";
+constexpr std::string_view suite_tag_name = "\t<testsuite";
+constexpr std::string_view suite_end_tag = "\t</testsuite>\n";
+} // namespace
+
+namespace {
+std::string make_start_tag(std::string_view name, std::string_view attributes, size_t capacity)
+{
+	if (attributes.size() > capacity) {
+		throw std::logic_error("junit_stream: tag attributes do not fit into reserved space");
+	}
+
+	std::string ret;
+	ret.reserve(name.size() + capacity + 2);
+	ret.append(name);
+	ret.append(attributes);
+
+	// pad with whitespace, which is allowed between attributes
+	ret.append(capacity - attributes.size(), ' ');
+	ret.append(">\n");
+
+	return ret;
+}
+} // namespace
+
+junit_stream::junit_stream(
+	const std::string& file_name,
+	std::string_view root_attributes,
+	size_t root_tag_capacity
+) :
+	file(file_name, std::ios::binary),
+	root_tag_capacity(root_tag_capacity)
+{
+	if (!this->file.is_open()) {
+		std::stringstream ss;
+		ss << "could not open JUnit report file for writing: " << file_name;
+		throw std::runtime_error(ss.str());
+	}
+
+	this->file << R"(<?xml version="1.0" encoding="UTF-8"?>)" << '\n';
+
+	this->root_tag_pos = this->file.tellp();
+	this->set_root_attributes(root_attributes);
+
+	this->end_pos = this->file.tellp();
+	this->write_end_tags_and_flush();
+}
+
+void junit_stream::write_end_tags_and_flush()
+{
+	this->file.seekp(this->end_pos);
+	if (this->is_suite_open) {
+		this->file << suite_end_tag;
+	}
+	this->file << root_end_tag;
+	this->file.flush();
+}
+
+void junit_stream::append(std::string_view chunk)
+{
+	this->buffer.append(chunk);
+}
+
+std::streamoff junit_stream::open_suite(std::string_view attributes, size_t capacity)
+{
+	if (this->is_suite_open) {
+		this->buffer.append(suite_end_tag);
+	}
+	this->is_suite_open = true;
+
+	auto pos = this->end_pos + std::streamoff(this->buffer.size());
+	this->buffer.append(make_start_tag(suite_tag_name, attributes, capacity));
+	return pos;
+}
+
+void junit_stream::set_suite_attributes(std::streamoff pos, std::string_view attributes, size_t capacity)
+{
+	auto tag = make_start_tag(suite_tag_name, attributes, capacity);
+
+	if (pos >= this->end_pos) {
+		// the tag is not written to the file yet
+		this->buffer.replace(size_t(pos - this->end_pos), tag.size(), tag);
+		return;
+	}
+
+	// the tag is written to the file, it will reach the disk on next flush
+	this->file.seekp(pos);
+	this->file << tag;
+}
+
+void junit_stream::set_root_attributes(std::string_view root_attributes)
+{
+	this->file.seekp(this->root_tag_pos);
+	this->file << make_start_tag(root_tag_name, root_attributes, this->root_tag_capacity);
+	this->file.flush();
+}
+
+void junit_stream::flush()
+{
+	this->file.seekp(this->end_pos);
+	this->file << this->buffer;
+	this->end_pos = this->file.tellp();
+	this->buffer.clear();
+
+	this->write_end_tags_and_flush();
+}
@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace tst {
+
+/**
+ * @brief Incrementally written JUnit report file.
+ * The appended chunks are buffered in memory and written to the file on flush().
+ * The file is kept well-formed after each flush: the chunks are written before
+ * the closing tags which are rewritten after each flush. Space for the root start
+ * tag attributes and for the test suite start tag attributes is reserved, so that
+ * the attributes, like the test counters, can be updated in place.
+ */
+class junit_stream
+{
+	std::ofstream file;
+
+	size_t root_tag_capacity;
+
+	std::streamoff root_tag_pos = 0;
+
+	// position of the closing tags
+	std::streamoff end_pos = 0;
+
+	// chunks appended after the last flush, to be written at end_pos
+	std::string buffer;
+
+	// whether the last test suite element is not closed yet
+	bool is_suite_open = false;
+
+	void write_end_tags_and_flush();
+
+public:
+	/**
+	 * @brief Constructor.
+	 * Creates the file and writes XML declaration, root start tag and root end tag.
+	 * @param file_name - name of the file to write.
+	 * @param root_attributes - initial attributes of the root tag.
+	 * @param root_tag_capacity - maximal length of the root tag attributes.
+	 * @throw std::runtime_error - in case the file could not be opened.
+	 */
+	junit_stream(const std::string& file_name, std::string_view root_attributes, size_t root_tag_capacity);
+
+	/**
+	 * @brief Append chunk to the report.
+	 * The chunk is buffered till next flush().
+	 * @param chunk - XML to insert.
+	 */
+	void append(std::string_view chunk);
+
+	/**
+	 * @brief Open test suite element.
+	 * Appends test suite start tag. Previously opened test suite element is closed.
+	 * @param attributes - initial attributes of the test suite tag.
+	 * @param capacity - maximal length of the test suite tag attributes.
+	 * @return position of the test suite start tag, to be passed to set_suite_attributes().
+	 */
+	std::streamoff open_suite(std::string_view attributes, size_t capacity);
+
+	/**
+	 * @brief Rewrite test suite tag attributes.
+	 * @param pos - position of the test suite start tag, as returned by open_suite().
+	 * @param attributes - new attributes of the test suite tag.
+	 * @param capacity - same capacity as passed to open_suite().
+	 * @throw std::logic_error - in case the attributes do not fit into the reserved space.
+	 */
+	void set_suite_attributes(std::streamoff pos, std::string_view attributes, size_t capacity);
+
+	/**
+	 * @brief Rewrite the root tag attributes.
+	 * @param root_attributes - new attributes of the root tag.
+	 * @throw std::logic_error - in case the attributes do not fit into the reserved space.
+	 */
+	void set_root_attributes(std::string_view root_attributes);
+
+	/**
+	 * @brief Write buffered chunks to the file.
+	 * The chunks are inserted before the closing tags and the file is flushed.
+	 */
+	void flush();
+};
+
+} // namespace tst
@@ -33,6 +33,7 @@ SOFTWARE.
 
 #include "application.hpp"
 #include "settings.hxx"
+#include "tracer.hxx"
 #include "util.hxx"
 
 namespace tst {
@@ -66,19 +67,35 @@ int main(utki::span<const char*> args)
 		return 0;
 	}
 
-	app->init();
+	if (settings::inst().shard_index >= settings::inst().shard_count) {
+		throw std::invalid_argument("--shard-index argument value must be less than --shard-count");
+	}
 
-	if (settings::inst().list_tests) {
-		app->list_tests(std::cout);
+	if (settings::inst().suite_name.empty() && !settings::inst().test_name.empty()) {
+		throw std::invalid_argument("--test argument requires --suite argument");
+	}
+
+	if (settings::inst().list_suites) {
+		app->list_suites(std::cout);
 		return 0;
 	}
 
+	{
+		trace_phase phase("init");
+		app->select_suites_to_init();
+		app->init();
+		app->build_test_table();
+	}
+
 	if (!settings::inst().suite_name.empty()) {
 		app->set_run_list_from_suite_and_test_name();
-	} else if (!settings::inst().test_name.empty()) {
-		throw std::invalid_argument("--test argument requires --suite argument");
 	} else if (settings::inst().run_list_stdin) {
-		app->read_run_list_from_stdin();
+		app->parse_run_list();
+	}
+
+	if (settings::inst().list_tests) {
+		app->list_tests(std::cout);
+		return 0;
 	}
 
 	return app->run();
@@ -0,0 +1,211 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "perf_counters.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <utki/debug.hpp>
+
+#if CFG_OS == CFG_OS_LINUX
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+#include "settings.hxx"
+
+using namespace tst;
+
+#if CFG_OS == CFG_OS_LINUX
+namespace {
+struct counter_info {
+	std::string_view name;
+	uint32_t type;
+	uint64_t config;
+};
+} // namespace
+
+namespace {
+const std::array<counter_info, perf_counters::max_num_counters> known_counters = {
+	{
+		{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+		{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+		{"cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+		{"cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+		{"branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+		{"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+		{"task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+		{"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+		{"context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+	}
+};
+} // namespace
+
+namespace {
+const counter_info& find_counter(std::string_view name)
+{
+	auto i = std::find_if(known_counters.begin(), known_counters.end(), [&name](const auto& c) {
+		return c.name == name;
+	});
+	ASSERT(i != known_counters.end())
+	return *i;
+}
+} // namespace
+
+namespace {
+int perf_event_open(perf_event_attr& attr, int group_fd)
+{
+	// measure the calling thread on any CPU
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+	return int(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+} // namespace
+
+void perf_counters::open()
+{
+	this->close();
+
+	for (const auto& name : settings::inst().perf_counters) {
+		const auto& c = find_counter(name);
+
+		perf_event_attr attr{};
+		attr.size = sizeof(attr);
+		attr.type = c.type;
+		attr.config = c.config;
+		attr.read_format = PERF_FORMAT_GROUP;
+
+		// counting user space only does not require special privileges
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		bool is_leader = this->fds.empty();
+		attr.disabled = is_leader ? 1 : 0;
+
+		int fd = perf_event_open(attr, is_leader ? -1 : this->fds.front());
+		if (fd < 0) {
+			std::stringstream ss;
+			ss << "perf_event_open() failed for '" << name << "' counter: " << std::strerror(errno)
+			   << ", check /proc/sys/kernel/perf_event_paranoid";
+			this->close();
+			throw std::runtime_error(ss.str());
+		}
+		this->fds.push_back(fd);
+	}
+
+	this->pid = getpid();
+}
+
+void perf_counters::close() noexcept
+{
+	// close group members first
+	for (auto i = this->fds.rbegin(); i != this->fds.rend(); ++i) {
+		::close(*i);
+	}
+	this->fds.clear();
+}
+
+perf_counters::~perf_counters()
+{
+	this->close();
+}
+
+bool perf_counters::is_known(std::string_view name) noexcept
+{
+	return std::any_of(known_counters.begin(), known_counters.end(), [&name](const auto& c) {
+		return c.name == name;
+	});
+}
+
+perf_counters& perf_counters::this_thread()
+{
+	thread_local perf_counters counters;
+	// after fork() the inherited counters measure the thread of the parent process,
+	// so the counters have to be reopened
+	if (counters.pid != getpid()) {
+		counters.open();
+	}
+	return counters;
+}
+
+void perf_counters::start()
+{
+	if (this->fds.empty()) {
+		return;
+	}
+	auto leader = this->fds.front();
+	ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+std::vector<uint64_t> perf_counters::stop()
+{
+	if (this->fds.empty()) {
+		return {};
+	}
+	auto leader = this->fds.front();
+	ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	// read format: number of counters followed by the values
+	std::array<uint64_t, max_num_counters + 1> buf{};
+	auto n = read(leader, buf.data(), sizeof(buf));
+	if (n < ssize_t(sizeof(uint64_t)) || buf[0] != this->fds.size()) {
+		return {};
+	}
+
+	return {std::next(buf.begin()), std::next(buf.begin(), ptrdiff_t(buf[0] + 1))};
+}
+
+#else
+
+bool perf_counters::is_known(std::string_view /* name */) noexcept
+{
+	// performance counters are only supported on Linux
+	return false;
+}
+
+perf_counters& perf_counters::this_thread()
+{
+	thread_local perf_counters counters;
+	return counters;
+}
+
+perf_counters::~perf_counters() = default;
+
+void perf_counters::start() {}
+
+std::vector<uint64_t> perf_counters::stop()
+{
+	return {};
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <utki/config.hpp>
+
+#if CFG_OS == CFG_OS_LINUX
+#	include <sys/types.h>
+#endif
+
+namespace tst {
+
+/**
+ * @brief Hardware performance counters of a thread.
+ * The counters are opened with perf_event_open() lazily, on first use by the thread,
+ * as a single group, so that all the counters measure the same time interval.
+ * Only supported on Linux.
+ */
+class perf_counters
+{
+#if CFG_OS == CFG_OS_LINUX
+	// group leader is the first one
+	std::vector<int> fds;
+
+	// process which has opened the counters, after fork() the counters have to be reopened
+	pid_t pid = -1;
+
+	void open();
+	void close() noexcept;
+#endif
+
+	perf_counters() = default;
+
+public:
+	/**
+	 * @brief Maximal number of counters.
+	 */
+	constexpr static const size_t max_num_counters = 9;
+
+	perf_counters(const perf_counters&) = delete;
+	perf_counters& operator=(const perf_counters&) = delete;
+
+	perf_counters(perf_counters&&) = delete;
+	perf_counters& operator=(perf_counters&&) = delete;
+
+	~perf_counters();
+
+	/**
+	 * @brief Check if counter name is known.
+	 * @param name - counter name, e.g. 'cycles'.
+	 * @return true if the counter is known.
+	 */
+	static bool is_known(std::string_view name) noexcept;
+
+	/**
+	 * @brief Get performance counters of the calling thread.
+	 * The counters selected with --perf-counters are opened on first call by the thread.
+	 * @return counters of the calling thread.
+	 * @throw std::runtime_error - in case opening the counters has failed.
+	 */
+	static perf_counters& this_thread();
+
+	/**
+	 * @brief Reset and start counting.
+	 */
+	void start();
+
+	/**
+	 * @brief Stop counting.
+	 * @return counts in the order of counters selected with --perf-counters.
+	 */
+	std::vector<uint64_t> stop();
+};
+
+} // namespace tst
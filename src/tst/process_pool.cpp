@@ -0,0 +1,522 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "process_pool.hxx"
+
+#if CFG_OS != CFG_OS_WINDOWS
+
+#	include <algorithm>
+#	include <cerrno>
+#	include <csignal>
+#	include <cstring>
+#	include <iostream>
+#	include <iterator>
+#	include <new>
+#	include <sstream>
+#	include <stdexcept>
+
+#	include <poll.h>
+#	include <sys/mman.h>
+#	include <sys/wait.h>
+#	include <unistd.h>
+#	include <utki/time.hpp>
+
+using namespace tst;
+
+namespace {
+bool read_all(int fd, void* buf, size_t size)
+{
+	auto p = static_cast<uint8_t*>(buf);
+	while (size != 0) {
+		auto n = read(fd, p, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		size -= size_t(n);
+	}
+	return true;
+}
+} // namespace
+
+namespace {
+bool write_all(int fd, const void* buf, size_t size)
+{
+	auto p = static_cast<const uint8_t*>(buf);
+	while (size != 0) {
+		auto n = write(fd, p, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		size -= size_t(n);
+	}
+	return true;
+}
+} // namespace
+
+namespace {
+void throw_errno(const char* what)
+{
+	std::stringstream ss;
+	ss << "process_pool: " << what << " failed: " << std::strerror(errno);
+	throw std::runtime_error(ss.str());
+}
+} // namespace
+
+process_pool::process_pool(size_t num_workers, run_task_type run_task) :
+	run_task(std::move(run_task)),
+	workers(num_workers)
+{
+	ASSERT(num_workers != 0)
+
+	this->shared_memory_size = sizeof(result_ring) * num_workers;
+	this->shared_memory = mmap(
+		nullptr,
+		this->shared_memory_size,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS,
+		-1,
+		0
+	);
+	if (this->shared_memory == MAP_FAILED) {
+		this->shared_memory = nullptr;
+		throw_errno("mmap()");
+	}
+
+	for (size_t i = 0; i != num_workers; ++i) {
+		new (&this->ring(i)) result_ring();
+	}
+
+	// writing to a pipe of a dead worker should not kill the parent process
+	this->old_sigpipe_handler = std::signal(SIGPIPE, SIG_IGN);
+
+	try {
+		for (size_t i = 0; i != num_workers; ++i) {
+			this->spawn(i);
+		}
+	} catch (...) {
+		this->stop_all_workers();
+		throw;
+	}
+}
+
+process_pool::~process_pool()
+{
+	this->stop_all_workers();
+}
+
+void process_pool::stop_all_workers()
+{
+	for (size_t i = 0; i != this->workers.size(); ++i) {
+		if (this->workers[i].pid >= 0) {
+			this->wait_worker(i);
+		}
+	}
+
+	if (this->shared_memory) {
+		munmap(this->shared_memory, this->shared_memory_size);
+		this->shared_memory = nullptr;
+	}
+
+	std::signal(SIGPIPE, this->old_sigpipe_handler);
+}
+
+process_pool::result_ring& process_pool::ring(size_t index) noexcept
+{
+	ASSERT(index < this->workers.size())
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	return static_cast<result_ring*>(this->shared_memory)[index];
+}
+
+void process_pool::spawn(size_t index)
+{
+	auto& w = this->workers[index];
+	ASSERT(w.pid < 0)
+	ASSERT(w.in_flight.empty())
+
+	std::array<int, 2> task_pipe = {-1, -1};
+	std::array<int, 2> done_pipe = {-1, -1};
+	if (pipe(task_pipe.data()) != 0) {
+		throw_errno("pipe()");
+	}
+	if (pipe(done_pipe.data()) != 0) {
+		close(task_pipe[0]);
+		close(task_pipe[1]);
+		throw_errno("pipe()");
+	}
+
+	auto& r = this->ring(index);
+	r.head.store(0, std::memory_order_relaxed);
+	r.started.store(0, std::memory_order_relaxed);
+	w.tail = 0;
+
+	// flush buffered output, otherwise it will be duplicated by the worker process
+	std::cout.flush();
+
+	pid_t pid = fork();
+	if (pid < 0) {
+		for (auto fd : {task_pipe[0], task_pipe[1], done_pipe[0], done_pipe[1]}) {
+			close(fd);
+		}
+		throw_errno("fork()");
+	}
+
+	if (pid == 0) {
+		// worker process
+		close(task_pipe[1]);
+		close(done_pipe[0]);
+
+		// close pipes of other workers, otherwise they will not get end-of-file
+		// when the parent process closes its ends of the pipes
+		for (const auto& ow : this->workers) {
+			if (ow.task_fd >= 0) {
+				close(ow.task_fd);
+			}
+			if (ow.done_fd >= 0) {
+				close(ow.done_fd);
+			}
+		}
+
+		this->worker_main(task_pipe[0], done_pipe[1], r);
+	}
+
+	close(task_pipe[0]);
+	close(done_pipe[1]);
+
+	w.pid = pid;
+	w.task_fd = task_pipe[1];
+	w.done_fd = done_pipe[0];
+}
+
+void process_pool::worker_main(int task_fd, int done_fd, result_ring& ring)
+{
+	// the worker process must never return to the caller's code,
+	// so all exceptions are caught and the process exits with _exit()
+	try {
+		for (uint32_t head = 0;; ++head) {
+			uint32_t task = 0;
+			if (!read_all(task_fd, &task, sizeof(task))) {
+				// end-of-file, parent process has no more tasks for us
+				break;
+			}
+
+			ring.start_ticks.store(utki::get_ticks_ms(), std::memory_order_relaxed);
+			ring.started.store(head + 1, std::memory_order_release);
+
+			auto begin_us = tracer::now_us();
+			auto res = this->run_task(task);
+			auto end_us = tracer::now_us();
+			std::cout.flush();
+
+			auto& slot = ring.slots[head % ring_capacity];
+			slot.task = task;
+			slot.status = uint8_t(res.status);
+			slot.time_ms = res.time_ms;
+			slot.message_size = uint32_t(std::min(res.message.size(), slot.message.size()));
+			std::memcpy(slot.message.data(), res.message.data(), slot.message_size);
+			ASSERT(res.perf_counts.size() <= slot.perf_counts.size())
+			slot.num_perf_counts = uint32_t(res.perf_counts.size());
+			std::copy(res.perf_counts.begin(), res.perf_counts.end(), slot.perf_counts.begin());
+			slot.has_allocs = res.allocs.has_value();
+			if (res.allocs) {
+				slot.allocs = res.allocs.value();
+			}
+			slot.span = {begin_us, end_us};
+
+			ring.head.store(head + 1, std::memory_order_release);
+
+			// notify parent process that the result is ready
+			char c = 0;
+			if (!write_all(done_fd, &c, sizeof(c))) {
+				break;
+			}
+		}
+	} catch (...) {
+		std::cout.flush();
+		_exit(1);
+	}
+
+	std::cout.flush();
+	_exit(0);
+}
+
+bool process_pool::dispatch(size_t index, scheduler& sched)
+{
+	auto& w = this->workers[index];
+
+	// Tasks waiting in the worker's pipe would hold their resources and weights
+	// without running, so in case tasks have requirements, send only one task at a time.
+	size_t max_in_flight = sched.has_requirements() ? 1 : ring_capacity;
+
+	while (w.in_flight.size() < max_in_flight) {
+		auto t = sched.try_pop(index);
+		if (!t) {
+			break;
+		}
+		auto task = uint32_t(*t);
+		if (!write_all(w.task_fd, &task, sizeof(task))) {
+			sched.push_front(index, *t);
+			return false;
+		}
+		w.in_flight.push_back(*t);
+	}
+	return true;
+}
+
+void process_pool::read_results(size_t index, scheduler& sched, const on_result_type& on_result)
+{
+	auto& w = this->workers[index];
+	const auto& r = this->ring(index);
+
+	for (uint32_t head = r.head.load(std::memory_order_acquire); w.tail != head; ++w.tail) {
+		const auto& slot = r.slots[w.tail % ring_capacity];
+
+		ASSERT(!w.in_flight.empty())
+		ASSERT(slot.task == w.in_flight.front())
+		w.in_flight.pop_front();
+
+		reporter::result res;
+		res.status = decltype(res.status)(slot.status);
+		res.time_ms = slot.time_ms;
+		res.message.assign(slot.message.data(), slot.message_size);
+		res.perf_counts.assign(slot.perf_counts.begin(), std::next(slot.perf_counts.begin(), slot.num_perf_counts));
+		if (slot.has_allocs) {
+			res.allocs = slot.allocs;
+		}
+
+		sched.done(slot.task);
+		on_result(index, slot.task, std::move(res), slot.span);
+	}
+}
+
+std::string process_pool::wait_worker(size_t index)
+{
+	auto& w = this->workers[index];
+	ASSERT(w.pid >= 0)
+
+	close(w.task_fd);
+	close(w.done_fd);
+	w.task_fd = -1;
+	w.done_fd = -1;
+
+	int status = 0;
+	while (waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {
+	}
+	w.pid = -1;
+
+	std::stringstream ss;
+	if (WIFSIGNALED(status)) {
+		ss << "worker process was terminated by signal " << WTERMSIG(status) << " (" << strsignal(WTERMSIG(status))
+		   << ")";
+	} else {
+		ss << "worker process exited with code " << WEXITSTATUS(status);
+	}
+	return ss.str();
+}
+
+uint32_t process_pool::running_time_ms(size_t index)
+{
+	const auto& w = this->workers[index];
+	const auto& r = this->ring(index);
+
+	// the oldest in flight task is running if it is the latest started task
+	if (w.in_flight.empty() || r.started.load(std::memory_order_acquire) != w.tail + 1) {
+		return 0;
+	}
+
+	return utki::get_ticks_ms() - r.start_ticks.load(std::memory_order_relaxed);
+}
+
+void process_pool::handle_worker_death(size_t index, scheduler& sched, const on_worker_died_type& on_worker_died)
+{
+	auto message = this->wait_worker(index);
+
+	auto& w = this->workers[index];
+
+	if (!w.in_flight.empty()) {
+		// the oldest task is the one during which the worker has died
+		auto time_ms = this->running_time_ms(index);
+		auto task = w.in_flight.front();
+		w.in_flight.pop_front();
+
+		sched.done(task);
+		on_worker_died(index, task, time_ms, std::move(message));
+	}
+
+	this->respawn(index, sched);
+}
+
+void process_pool::respawn(size_t index, scheduler& sched)
+{
+	auto& w = this->workers[index];
+
+	// return not started tasks to the scheduler, keeping their order
+	for (auto i = w.in_flight.rbegin(); i != w.in_flight.rend(); ++i) {
+		sched.push_front(index, *i);
+	}
+	w.in_flight.clear();
+
+	this->spawn(index);
+}
+
+int process_pool::check_timeouts(
+	scheduler& sched,
+	const task_timeout_type& task_timeout,
+	const on_result_type& on_result,
+	const on_worker_died_type& on_worker_died
+)
+{
+	int ret = -1;
+	auto update_ret = [&ret](uint32_t ms) {
+		ret = ret < 0 ? int(ms) : std::min(ret, int(ms));
+	};
+
+	for (size_t i = 0; i != this->workers.size(); ++i) {
+		auto& w = this->workers[i];
+		if (w.in_flight.empty()) {
+			continue;
+		}
+
+		auto task = w.in_flight.front();
+		auto timeout = task_timeout(task);
+
+		auto time_ms = this->running_time_ms(i);
+		if (time_ms == 0 || timeout == 0) {
+			// the oldest task has not started yet or it has no timeout, but the
+			// dispatched tasks can start any moment, so check again later in case
+			// any of those has a timeout
+			if (std::any_of(w.in_flight.begin(), w.in_flight.end(), [&task_timeout](size_t t) {
+					return task_timeout(t) != 0;
+				}))
+			{
+				update_ret(watchdog_period_ms);
+			}
+			continue;
+		}
+
+		if (time_ms < timeout) {
+			update_ret(std::min(timeout - time_ms, watchdog_period_ms));
+			continue;
+		}
+
+		kill(w.pid, SIGKILL);
+		this->wait_worker(i);
+
+		// the task could complete right before the worker was killed
+		this->read_results(i, sched, on_result);
+
+		if (!w.in_flight.empty() && w.in_flight.front() == task) {
+			w.in_flight.pop_front();
+
+			std::stringstream ss;
+			ss << "test timed out after " << time_ms << " ms, worker process was killed";
+			sched.done(task);
+			on_worker_died(i, task, time_ms, ss.str());
+		}
+
+		this->respawn(i, sched);
+
+		// the new worker has no tasks yet, check again right after dispatching
+		ret = 0;
+	}
+
+	return ret;
+}
+
+void process_pool::run(
+	scheduler& sched,
+	const task_timeout_type& task_timeout,
+	const on_result_type& on_result,
+	const on_worker_died_type& on_worker_died,
+	const on_tick_type& on_tick
+)
+{
+	ASSERT(sched.num_workers() == this->workers.size())
+
+	std::vector<pollfd> fds(this->workers.size());
+
+	for (;;) {
+		size_t num_in_flight = 0;
+		for (size_t i = 0; i != this->workers.size(); ++i) {
+			while (!this->dispatch(i, sched)) {
+				this->read_results(i, sched, on_result);
+				this->handle_worker_death(i, sched, on_worker_died);
+			}
+			num_in_flight += this->workers[i].in_flight.size();
+
+			fds[i].fd = this->workers[i].done_fd;
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+
+		if (num_in_flight == 0) {
+			break;
+		}
+
+		int poll_timeout = this->check_timeouts(sched, task_timeout, on_result, on_worker_died);
+		if (poll_timeout == 0) {
+			// some workers were killed and respawned, dispatch tasks to them
+			continue;
+		}
+
+		if (on_tick) {
+			auto tick_ms = int(on_tick());
+			poll_timeout = poll_timeout < 0 ? tick_ms : std::min(poll_timeout, tick_ms);
+		}
+
+		if (poll(fds.data(), fds.size(), poll_timeout) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw_errno("poll()");
+		}
+
+		for (size_t i = 0; i != fds.size(); ++i) {
+			if (fds[i].revents == 0) {
+				continue;
+			}
+
+			std::array<char, ring_capacity> buf{};
+			auto n = read(fds[i].fd, buf.data(), buf.size());
+
+			this->read_results(i, sched, on_result);
+
+			if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN)) {
+				// end-of-file, the worker process has died
+				this->handle_worker_death(i, sched, on_worker_died);
+			}
+		}
+	}
+}
+
+#endif // ~ CFG_OS != CFG_OS_WINDOWS
@@ -0,0 +1,210 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <utki/config.hpp>
+
+#if CFG_OS != CFG_OS_WINDOWS
+
+#	include <array>
+#	include <atomic>
+#	include <deque>
+#	include <functional>
+#	include <vector>
+
+#	include <sys/types.h>
+
+#	include "perf_counters.hxx"
+#	include "reporter.hxx"
+#	include "scheduler.hxx"
+#	include "tracer.hxx"
+
+namespace tst {
+
+/**
+ * @brief Pool of pre-forked worker processes.
+ * Worker processes are forked from the test application after the tests have
+ * been initialized, so each worker has the same set of tests as the parent
+ * process. The parent process sends task indices to the workers through
+ * pipes and the workers write the results to shared memory ring buffers,
+ * one ring per worker.
+ */
+class process_pool
+{
+public:
+	using run_task_type = std::function<reporter::result(size_t task)>;
+	using on_result_type = std::function<void(size_t worker, size_t task, reporter::result result, trace_span span)>;
+	using on_worker_died_type =
+		std::function<void(size_t worker, size_t task, uint32_t time_ms, std::string message)>;
+
+	// returns timeout of the task in milliseconds, zero means no timeout
+	using task_timeout_type = std::function<uint32_t(size_t task)>;
+
+	// returns number of milliseconds till the next call is needed
+	using on_tick_type = std::function<uint32_t()>;
+
+private:
+	// Maximum number of tasks sent to one worker and not yet completed.
+	constexpr static const size_t ring_capacity = 2;
+
+	constexpr static const size_t max_message_size = size_t(16) * 1024;
+
+	// Maximum time between checks for timed out tasks in case the task has not started yet.
+	constexpr static const uint32_t watchdog_period_ms = 100;
+
+	struct result_slot {
+		uint32_t task;
+		uint8_t status;
+		uint32_t time_ms;
+		uint32_t message_size;
+		std::array<char, max_message_size> message;
+		uint32_t num_perf_counts;
+		std::array<uint64_t, perf_counters::max_num_counters> perf_counts;
+		bool has_allocs;
+		alloc_stats allocs;
+		trace_span span;
+	};
+
+	struct result_ring {
+		// number of results written by the worker
+		std::atomic<uint32_t> head{0};
+
+		// number of tasks started by the worker
+		std::atomic<uint32_t> started{0};
+
+		// start time of the latest started task
+		std::atomic<uint32_t> start_ticks{0};
+
+		std::array<result_slot, ring_capacity> slots;
+	};
+
+	struct worker {
+		pid_t pid = -1;
+
+		// write end of the tasks pipe
+		int task_fd = -1;
+
+		// read end of the results notification pipe
+		int done_fd = -1;
+
+		// number of results read by the parent process
+		uint32_t tail = 0;
+
+		std::deque<size_t> in_flight;
+	};
+
+	const run_task_type run_task;
+
+	std::vector<worker> workers;
+
+	// shared memory with result rings
+	void* shared_memory = nullptr;
+	size_t shared_memory_size = 0;
+
+	void (*old_sigpipe_handler)(int) = nullptr;
+
+	result_ring& ring(size_t index) noexcept;
+
+	void spawn(size_t index);
+
+	[[noreturn]] void worker_main(int task_fd, int done_fd, result_ring& ring);
+
+	// returns false in case sending a task to the worker has failed
+	bool dispatch(size_t index, scheduler& sched);
+
+	void read_results(size_t index, scheduler& sched, const on_result_type& on_result);
+
+	// closes pipes to the worker and waits for the worker process to exit,
+	// returns the description of how the worker process has exited
+	std::string wait_worker(size_t index);
+
+	// returns for how long the oldest in flight task is running, zero if it has not started yet
+	uint32_t running_time_ms(size_t index);
+
+	void handle_worker_death(size_t index, scheduler& sched, const on_worker_died_type& on_worker_died);
+
+	// returns not completed tasks to the scheduler and forks a new worker process
+	void respawn(size_t index, scheduler& sched);
+
+	// kills workers which are running a task for longer than the task's timeout,
+	// returns number of milliseconds after which the timeouts have to be checked again, -1 means never
+	int check_timeouts(
+		scheduler& sched,
+		const task_timeout_type& task_timeout,
+		const on_result_type& on_result,
+		const on_worker_died_type& on_worker_died
+	);
+
+	void stop_all_workers();
+
+public:
+	/**
+	 * @brief Constructor.
+	 * Forks worker processes.
+	 * @param num_workers - number of worker processes.
+	 * @param run_task - function which runs a task in the worker process.
+	 */
+	process_pool(size_t num_workers, run_task_type run_task);
+
+	process_pool(const process_pool&) = delete;
+	process_pool& operator=(const process_pool&) = delete;
+
+	process_pool(process_pool&&) = delete;
+	process_pool& operator=(process_pool&&) = delete;
+
+	~process_pool();
+
+	size_t size() const noexcept
+	{
+		return this->workers.size();
+	}
+
+	/**
+	 * @brief Run all tasks.
+	 * Dispatches the tasks from the scheduler to the workers and collects the results.
+	 * In case a worker process dies while running a task, the task is reported
+	 * via on_worker_died callback and a new worker process is forked.
+	 * In case a task runs longer than its timeout, the worker process is killed
+	 * and the task is reported via on_worker_died callback as well.
+	 * @param sched - scheduler holding the tasks, must have as many workers as the pool.
+	 * @param task_timeout - function returning timeout of the task.
+	 * @param on_result - callback called for each completed task.
+	 * @param on_worker_died - callback called for each task during which the worker process died.
+	 * @param on_tick - callback called periodically while waiting for the results, can be nullptr.
+	 */
+	void run(
+		scheduler& sched,
+		const task_timeout_type& task_timeout,
+		const on_result_type& on_result,
+		const on_worker_died_type& on_worker_died,
+		const on_tick_type& on_tick = nullptr
+	);
+};
+
+} // namespace tst
+
+#endif // ~ CFG_OS != CFG_OS_WINDOWS
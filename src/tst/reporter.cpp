@@ -26,52 +26,76 @@ SOFTWARE.
 
 #include "reporter.hxx"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <ratio>
+#include <sstream>
+
+#include <utki/time.hpp>
 
 #include "settings.hxx"
 
 using namespace tst;
 
-void reporter::report(const full_id& id, suite::status result, uint32_t dt, std::string message)
+void reporter::report(const iterator& i, result r)
 {
-	std::lock_guard<decltype(this->mutex)> lock_guard(this->mutex);
-
-	auto si = this->app.suites.find(id.suite);
-	ASSERT(si != this->app.suites.end())
-
-	auto& s = si->second;
-
-	auto pi = s.tests.find(id.test);
-	ASSERT(pi != s.tests.end())
-
-	auto& info = pi->second;
-
-	info.result = result;
-	info.time_ms = dt;
-	info.message = std::move(message);
-
-	switch (result) {
-		case decltype(result)::passed:
-			++s.num_passed;
-			++this->num_passed;
+	const auto& res = i.result();
+
+	res.result = r.status;
+	res.time_ms = r.time_ms;
+	res.message = std::move(r.message);
+	res.benchmark = std::move(r.benchmark);
+	res.perf_counts = std::move(r.perf_counts);
+	res.allocs = r.allocs;
+
+	switch (r.status) {
+		case decltype(r.status)::passed:
+			this->num_passed.fetch_add(1, std::memory_order_relaxed);
 			break;
-		case decltype(result)::failed:
-			++s.num_failed;
-			++this->num_failed;
+		case decltype(r.status)::failed:
+			this->num_failed.fetch_add(1, std::memory_order_relaxed);
 			break;
-		case decltype(result)::errored:
-			++s.num_errors;
-			++this->num_errors;
+		case decltype(r.status)::errored:
+			this->num_errors.fetch_add(1, std::memory_order_relaxed);
 			break;
-		case decltype(result)::disabled:
-			++s.num_disabled;
-			++this->num_disabled;
+		case decltype(r.status)::disabled:
+			this->num_disabled.fetch_add(1, std::memory_order_relaxed);
 			break;
 		default:
 			break;
 	}
+
+	if (this->junit) {
+		if (i.info().is_benchmark && !settings::inst().bench_compare_file.empty()) {
+			std::lock_guard<decltype(this->junit_mutex)> lock_guard(this->junit_mutex);
+			this->deferred_junit_tests.push_back(i);
+		} else {
+			// format the test case before locking the mutex
+			std::stringstream ss;
+			write_junit_test_case(ss, i.id().test, res);
+			auto test_case = ss.str();
+
+			std::lock_guard<decltype(this->junit_mutex)> lock_guard(this->junit_mutex);
+			this->stream_junit_test(i, test_case);
+		}
+	}
+}
+
+void reporter::report_regression(const iterator& i, std::string message)
+{
+	const auto& res = i.result();
+
+	ASSERT(res.result == suite::status::passed)
+
+	res.result = suite::status::failed;
+	res.message = std::move(message);
+
+	ASSERT(this->num_passed != 0)
+	--this->num_passed;
+	++this->num_failed;
+
+	++this->num_regressions;
 }
 
 void reporter::print_num_tests_about_to_run(std::ostream& o) const
@@ -155,6 +179,20 @@ void reporter::print_num_tests_skipped(std::ostream& o) const
 	std::cout << " test(s) skipped" << std::endl;
 }
 
+void reporter::print_num_benchmark_regressions(std::ostream& o) const
+{
+	if (this->num_regressions == 0) {
+		return;
+	}
+
+	if (settings::inst().colored_output) {
+		o << "\033[1;31m" << this->num_regressions << "\033[0m";
+	} else {
+		o << this->num_regressions;
+	}
+	o << " benchmark regression(s)" << std::endl;
+}
+
 void reporter::print_num_warnings(std::ostream& o) const
 {
 	if (app.num_warnings == 0) {
@@ -192,97 +230,361 @@ void reporter::print_outcome(std::ostream& o) const
 	}
 }
 
-// See https://llg.cubic.org/docs/junit/ for junit report format
-void reporter::write_junit_report(const std::string& file_name) const
+namespace {
+template <typename value_type>
+void write_junit_property(std::ostream& f, std::string_view name, const value_type& value)
 {
-	std::ofstream f(file_name, std::ios::binary);
+	f << "\t\t\t\t<property name='" << name << "' value='" << value << "'/>" << '\n';
+}
+} // namespace
+
+namespace {
+void write_junit_properties(
+	std::ostream& f,
+	const std::optional<benchmark_result>& benchmark,
+	const std::vector<uint64_t>& perf_counts,
+	const std::optional<alloc_stats>& allocs
+)
+{
+	f << "\t\t\t<properties>" << '\n';
+	if (benchmark) {
+		const auto& b = benchmark.value();
+		write_junit_property(f, "ns_per_op", b.ns_per_op);
+		write_junit_property(f, "stddev_ns", b.stddev_ns);
+		write_junit_property(f, "iterations", b.iterations);
+		write_junit_property(f, "repetitions", b.repetitions);
+	}
+	const auto& names = settings::inst().perf_counters;
+	ASSERT(perf_counts.empty() || perf_counts.size() == names.size())
+	for (size_t i = 0; i != perf_counts.size(); ++i) {
+		write_junit_property(f, "perf." + names[i], perf_counts[i]);
+	}
+	if (allocs) {
+		const auto& a = allocs.value();
+		write_junit_property(f, "alloc.count", a.num_allocs);
+		write_junit_property(f, "alloc.bytes", a.num_bytes);
+		write_junit_property(f, "alloc.peak_bytes", a.peak_bytes);
+	}
+	f << "\t\t\t</properties>" << '\n';
+}
+} // namespace
 
-	f << R"(<?xml version="1.0" encoding="UTF-8"?>)" << '\n';
-	f << "<testsuites"
-		 " name='"
-	  << this->app.name
+namespace {
+// maximal length of the JUnit report root tag attributes, except the application name
+constexpr const size_t junit_root_attributes_capacity = 256;
+
+// maximal length of the JUnit report test suite tag attributes, except the suite name
+constexpr const size_t junit_suite_attributes_capacity = 256;
+
+// the streamed JUnit report is flushed when this much of test cases is pending
+constexpr const size_t junit_flush_size = 0x10000;
+
+// the streamed JUnit report is flushed at least this often, when results arrive
+constexpr const uint32_t junit_flush_period_ms = 1000;
+} // namespace
+
+reporter::reporter(const application& app) :
+	app(app),
+	num_tests(app.num_tests())
+{
+	const auto& s = settings::inst();
+	if (s.junit_streaming && !s.junit_report_out_file.empty()) {
+		this->junit.emplace(
+			s.junit_report_out_file,
+			this->make_junit_root_attributes(),
+			this->app.name.size() + junit_root_attributes_capacity
+		);
+
+		// tests of a suite are contiguous in the test table
+		const auto& table = this->app.test_table;
+		for (size_t i = 0; i != table.size(); ++i) {
+			if (i == 0 || table[i].suite != table[i - 1].suite) {
+				this->junit_suites.push_back({i, {}, {}});
+			}
+		}
+		this->junit_flush_ticks = utki::get_ticks_ms();
+	}
+}
+
+std::string reporter::make_junit_root_attributes() const
+{
+	std::stringstream ss;
+	ss << " name='" << this->app.name
+	   << "'"
+		  " tests='"
+	   << this->num_tests
+	   << "'"
+		  " disabled='"
+	   << this->num_disabled
+	   << "'"
+		  " errors='"
+	   << this->num_errors
+	   << "'"
+		  " failures='"
+	   << this->num_failed
+	   << "'"
+		  " skipped='"
+	   << this->num_skipped()
+	   << "'"
+		  " time='"
+	   << (double(this->time_ms) / std::milli::den) << "'";
+	return ss.str();
+}
+
+void reporter::junit_counters::add(const suite::test_result& t)
+{
+	++this->num_tests;
+	this->time_ms += t.time_ms;
+
+	switch (t.result) {
+		case suite::status::disabled:
+			++this->num_disabled;
+			break;
+		case suite::status::failed:
+			++this->num_failed;
+			break;
+		case suite::status::errored:
+			++this->num_errors;
+			break;
+		case suite::status::not_run:
+			++this->num_skipped;
+			break;
+		default:
+			break;
+	}
+}
+
+void reporter::junit_counters::add(const junit_counters& c)
+{
+	this->num_tests += c.num_tests;
+	this->num_disabled += c.num_disabled;
+	this->num_failed += c.num_failed;
+	this->num_errors += c.num_errors;
+	this->num_skipped += c.num_skipped;
+	this->time_ms += c.time_ms;
+}
+
+void reporter::write_junit_suite_attributes(std::ostream& o, std::string_view name, const junit_counters& c)
+{
+	o << " name='" << name
 	  << "'"
 		 " tests='"
-	  << this->num_tests
+	  << c.num_tests
 	  << "'"
 		 " disabled='"
-	  << this->num_disabled
-	  << "'"
-		 " errors='"
-	  << this->num_errors
+	  << c.num_disabled
 	  << "'"
 		 " failures='"
-	  << this->num_failed
+	  << c.num_failed
+	  << "'"
+		 " errors='"
+	  << c.num_errors
 	  << "'"
 		 " skipped='"
-	  << this->num_skipped()
+	  << c.num_skipped
 	  << "'"
 		 " time='"
-	  << (double(this->time_ms) / std::milli::den) << "'>" << '\n';
-
-	for (const auto& si : this->app.suites) {
-		auto& s = si.second;
-		f << "\t<testsuite"
-			 " name='"
-		  << si.first
-		  << "'"
-			 " tests='"
-		  << s.size()
-		  << "'"
-			 " disabled='"
-		  << s.num_disabled
-		  << "'"
-			 " failures='"
-		  << s.num_failed
-		  << "'"
-			 " errors='"
-		  << s.num_errors
-		  << "'"
-			 " skipped='"
-		  << s.num_skipped()
-		  << "'"
-		  //" time='" << "TODO: set time in seconds" << '\''
-		  << '>' << '\n';
-
-		for (const auto& ti : s.tests) {
-			auto& t = ti.second;
-
-			f << "\t\t<testcase"
-				 " name='"
-			  << ti.first
-			  << "'"
-				 " status='"
-			  << suite::status_to_string(t.result)
-			  << "'"
-				 " time='"
-			  << (double(t.time_ms) / std::milli::den) << '\'';
-
-			switch (t.result) {
-				case suite::status::errored:
-				case suite::status::failed:
-				case suite::status::not_run:
-					f << '>' << '\n';
-					f << "\t\t\t<" << ([&]() {
-						switch (t.result) {
-							default:
-								ASSERT(false)
-							case suite::status::errored:
-								return "error";
-							case suite::status::failed:
-								return "failure";
-							case suite::status::not_run:
-								return "skipped";
-						}
-					}())
-					  << " message='" << t.message << "'/>" << '\n';
-					f << "\t\t</testcase>";
-					break;
-				default:
-					f << "/>";
+	  << (double(c.time_ms) / std::milli::den) << "'";
+}
+
+void reporter::write_junit_test_case(std::ostream& o, std::string_view name, const suite::test_result& t)
+{
+	o << "\t\t<testcase"
+		 " name='"
+	  << name
+	  << "'"
+		 " status='"
+	  << suite::status_to_string(t.result)
+	  << "'"
+		 " time='"
+	  << (double(t.time_ms) / std::milli::den) << '\'';
+
+	switch (t.result) {
+		case suite::status::errored:
+		case suite::status::failed:
+		case suite::status::not_run:
+			o << '>' << '\n';
+			if (t.benchmark || !t.perf_counts.empty() || t.allocs) {
+				write_junit_properties(o, t.benchmark, t.perf_counts, t.allocs);
+			}
+			o << "\t\t\t<" << ([&]() {
+				switch (t.result) {
+					default:
+						ASSERT(false)
+					case suite::status::errored:
+						return "error";
+					case suite::status::failed:
+						return "failure";
+					case suite::status::not_run:
+						return "skipped";
+				}
+			}())
+			  << " message='" << t.message << "'/>" << '\n';
+			o << "\t\t</testcase>";
+			break;
+		default:
+			if (t.benchmark || !t.perf_counts.empty() || t.allocs) {
+				o << '>' << '\n';
+				write_junit_properties(o, t.benchmark, t.perf_counts, t.allocs);
+				o << "\t\t</testcase>";
+			} else {
+				o << "/>";
 			}
+	}
+
+	o << '\n';
+}
+
+void reporter::stream_junit_test(const iterator& i, std::string_view test_case)
+{
+	ASSERT(this->junit)
+
+	// find the suite by index of its first test
+	auto si = std::upper_bound(
+		this->junit_suites.begin(),
+		this->junit_suites.end(),
+		i.index(),
+		[](size_t index, const junit_suite& s) {
+			return index < s.begin;
+		}
+	);
+	ASSERT(si != this->junit_suites.begin())
+	--si;
+
+	if (si->pending.empty()) {
+		this->junit_pending_suites.push_back(size_t(std::distance(this->junit_suites.begin(), si)));
+	}
+	si->pending.append(test_case);
+	si->pending_counters.add(i.result());
+	this->junit_pending_size += test_case.size();
+
+	if (this->junit_pending_size >= junit_flush_size ||
+		utki::get_ticks_ms() - this->junit_flush_ticks >= junit_flush_period_ms)
+	{
+		this->flush_junit();
+	}
+}
+
+void reporter::flush_junit()
+{
+	ASSERT(this->junit)
+
+	auto make_attributes = [this](size_t suite_index, const junit_counters& c) {
+		std::stringstream ss;
+		write_junit_suite_attributes(ss, *this->app.test_table[this->junit_suites[suite_index].begin].suite, c);
+		return ss.str();
+	};
+
+	auto get_capacity = [this](size_t suite_index) {
+		return this->app.test_table[this->junit_suites[suite_index].begin].suite->size() +
+			junit_suite_attributes_capacity;
+	};
+
+	auto finalize_open_suite = [&]() {
+		if (this->junit_open_suite == no_suite) {
+			return;
+		}
+		this->junit->set_suite_attributes(
+			this->junit_open_suite_pos,
+			make_attributes(this->junit_open_suite, this->junit_open_counters),
+			get_capacity(this->junit_open_suite)
+		);
+	};
+
+	for (auto index : this->junit_pending_suites) {
+		auto& s = this->junit_suites[index];
+
+		// the test cases are appended to the open test suite element in case it is the same suite,
+		// otherwise a new test suite element is started
+		if (index != this->junit_open_suite) {
+			finalize_open_suite();
+			this->junit_open_suite = index;
+			this->junit_open_counters = {};
+			this->junit_open_suite_pos = this->junit->open_suite(
+				make_attributes(index, this->junit_open_counters),
+				get_capacity(index)
+			);
+		}
+
+		this->junit->append(s.pending);
+		this->junit_open_counters.add(s.pending_counters);
+
+		s.pending.clear();
+		s.pending.shrink_to_fit();
+		s.pending_counters = {};
+	}
+	finalize_open_suite();
+
+	this->junit_pending_suites.clear();
+	this->junit_pending_size = 0;
+
+	this->junit->flush();
+	this->junit_flush_ticks = utki::get_ticks_ms();
+}
+
+uint32_t reporter::flush_junit_if_due()
+{
+	std::lock_guard<decltype(this->junit_mutex)> lock_guard(this->junit_mutex);
+
+	ASSERT(this->junit)
+
+	uint32_t elapsed_ms = utki::get_ticks_ms() - this->junit_flush_ticks;
+	if (elapsed_ms < junit_flush_period_ms) {
+		return junit_flush_period_ms - elapsed_ms;
+	}
+
+	if (!this->junit_pending_suites.empty()) {
+		this->flush_junit();
+	}
+	return junit_flush_period_ms;
+}
+
+void reporter::finish_junit_report()
+{
+	std::lock_guard<decltype(this->junit_mutex)> lock_guard(this->junit_mutex);
+
+	ASSERT(this->junit)
+
+	for (const auto& i : this->deferred_junit_tests) {
+		std::stringstream ss;
+		write_junit_test_case(ss, i.id().test, i.result());
+		this->stream_junit_test(i, ss.str());
+	}
+	this->deferred_junit_tests.clear();
+
+	this->flush_junit();
+
+	this->junit->set_root_attributes(this->make_junit_root_attributes());
+}
+
+// See https://llg.cubic.org/docs/junit/ for junit report format
+void reporter::write_junit_report(const std::string& file_name) const
+{
+	std::ofstream f(file_name, std::ios::binary);
+
+	f << R"(<?xml version="1.0" encoding="UTF-8"?>)" << '\n';
+	f << "<testsuites" << this->make_junit_root_attributes() << ">" << '\n';
+
+	const auto& table = this->app.test_table;
+	for (size_t begin = 0; begin != table.size();) {
+		const auto* suite_name = table[begin].suite;
+
+		junit_counters counters;
+
+		// tests of a suite are contiguous in the test table
+		size_t end = begin;
+		for (; end != table.size() && table[end].suite == suite_name; ++end) {
+			counters.add(table[end].result);
+		}
+
+		f << "\t<testsuite";
+		write_junit_suite_attributes(f, *suite_name, counters);
+		f << '>' << '\n';
 
-			f << '\n';
+		for (iterator i(this->app, begin); i.index() != end; i.next()) {
+			write_junit_test_case(f, i.id().test, i.result());
 		}
+		begin = end;
 
 		f << "\t</testsuite>" << '\n';
 	}
@@ -26,10 +26,16 @@ SOFTWARE.
 
 #pragma once
 
+#include <atomic>
+#include <limits>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "application.hpp"
+#include "iterator.hxx"
+#include "junit_stream.hxx"
 #include "suite.hpp"
 #include "util.hxx"
 
@@ -37,55 +43,157 @@ namespace tst {
 class reporter
 {
 private:
-	std::mutex mutex;
+	// guards the streamed JUnit report
+	std::mutex junit_mutex;
 	const application& app;
 
 	const size_t num_tests;
 
-	size_t num_failed = 0;
-	size_t num_passed = 0;
-	size_t num_disabled = 0;
-	size_t num_errors = 0;
+	// Results are reported concurrently by the runner threads. Each test's result is stored
+	// right to its own test_result, so only the counters are shared.
+	std::atomic<size_t> num_failed{0};
+	std::atomic<size_t> num_passed{0};
+	std::atomic<size_t> num_disabled{0};
+	std::atomic<size_t> num_errors{0};
 
-	// thread safe
-	void report(const full_id& id, suite::status result, uint32_t dt, std::string message = std::string());
+	size_t num_regressions = 0;
+
+	// set in case the JUnit report is written incrementally, see --junit-streaming
+	std::optional<junit_stream> junit;
+
+	// benchmarks are written to the streamed JUnit report only after comparing them with the baseline
+	std::vector<iterator> deferred_junit_tests;
+
+	// counters of a JUnit test suite element
+	struct junit_counters {
+		size_t num_tests = 0;
+		size_t num_disabled = 0;
+		size_t num_failed = 0;
+		size_t num_errors = 0;
+		size_t num_skipped = 0;
+		uint32_t time_ms = 0;
+
+		void add(const suite::test_result& t);
+		void add(const junit_counters& c);
+	};
+
+	struct junit_suite {
+		// index of the suite's first test in the test table
+		size_t begin;
+
+		// test cases which are not written to the streamed JUnit report yet
+		std::string pending;
+		junit_counters pending_counters;
+	};
+
+	// Suite index of the streamed JUnit report, in the test table order.
+	// Results are collected per suite and written on flush, so that each flush
+	// writes one test suite element per suite.
+	std::vector<junit_suite> junit_suites;
+
+	// indices of the suites which have pending test cases
+	std::vector<size_t> junit_pending_suites;
+	size_t junit_pending_size = 0;
+	uint32_t junit_flush_ticks = 0;
+
+	constexpr static const size_t no_suite = std::numeric_limits<size_t>::max();
+
+	// test suite element which is open at the end of the streamed JUnit report,
+	// its attributes are updated in place on each flush
+	size_t junit_open_suite = no_suite;
+	std::streamoff junit_open_suite_pos = 0;
+	junit_counters junit_open_counters;
+
+	std::string make_junit_root_attributes() const;
+
+	static void write_junit_suite_attributes(std::ostream& o, std::string_view name, const junit_counters& c);
+
+	static void write_junit_test_case(std::ostream& o, std::string_view name, const suite::test_result& t);
+
+	// adds the test case to the suite's pending test cases of the streamed JUnit report,
+	// must be called with junit_mutex locked
+	void stream_junit_test(const iterator& i, std::string_view test_case);
+
+	// writes pending test cases to the streamed JUnit report, must be called with junit_mutex locked
+	void flush_junit();
 
 public:
 	uint32_t time_ms = 0;
 
-	reporter(const application& app) :
-		app(app),
-		num_tests(app.num_tests())
-	{}
+	reporter(const application& app);
 
-	// thread safe
-	void report_pass(const full_id& id, uint32_t dt)
-	{
-		this->report(id, suite::status::passed, dt);
-	}
+	/**
+	 * @brief Result of a test run.
+	 */
+	struct result {
+		suite::status status = suite::status::not_run;
+		uint32_t time_ms = 0;
+		std::string message;
+		std::optional<benchmark_result> benchmark;
 
-	// thread safe
-	void report_failure(const full_id& id, uint32_t dt, std::string message)
-	{
-		this->report(id, suite::status::failed, dt, std::move(message));
-	}
+		// in the order of counters selected with --perf-counters
+		std::vector<uint64_t> perf_counts;
+
+		// set in case the allocations are tracked, see alloc_hook.hpp
+		std::optional<alloc_stats> allocs;
 
+		static result pass(uint32_t dt)
+		{
+			result r;
+			r.status = suite::status::passed;
+			r.time_ms = dt;
+			return r;
+		}
+
+		static result failure(uint32_t dt, std::string message)
+		{
+			result r;
+			r.status = suite::status::failed;
+			r.time_ms = dt;
+			r.message = std::move(message);
+			return r;
+		}
+
+		static result error(uint32_t dt, std::string message)
+		{
+			result r;
+			r.status = suite::status::errored;
+			r.time_ms = dt;
+			r.message = std::move(message);
+			return r;
+		}
+	};
+
+private:
 	// thread safe
-	void report_error(const full_id& id, uint32_t dt, std::string message)
+	void report(const iterator& i, result r);
+
+public:
+	// Thread safe.
+	// Each test must be reported only once.
+	void report_result(const iterator& i, result r)
 	{
-		this->report(id, suite::status::errored, dt, std::move(message));
+		this->report(i, std::move(r));
 	}
 
+	// Not thread safe.
+	// Changes result of the passed benchmark to failed.
+	void report_regression(const iterator& i, std::string message);
+
 	// thread safe
-	void report_skipped(const full_id& id, std::string message)
+	void report_skipped(const iterator& i, std::string message)
 	{
-		this->report(id, suite::status::not_run, 0, std::move(message));
+		result r;
+		r.message = std::move(message);
+		this->report(i, std::move(r));
 	}
 
 	// thread safe
-	void report_disabled_test(const full_id& id)
+	void report_disabled_test(const iterator& i)
 	{
-		this->report(id, suite::status::disabled, 0);
+		result r;
+		r.status = suite::status::disabled;
+		this->report(i, std::move(r));
 	}
 
 	size_t num_unsuccessful() const noexcept
@@ -115,6 +223,7 @@ public:
 	void print_num_tests_disabled(std::ostream& o) const;
 	void print_num_tests_failed(std::ostream& o) const;
 	void print_num_tests_skipped(std::ostream& o) const;
+	void print_num_benchmark_regressions(std::ostream& o) const;
 	void print_num_warnings(std::ostream& o) const;
 	void print_outcome(std::ostream& o) const;
 
@@ -129,6 +238,20 @@ public:
 	}
 
 	void write_junit_report(const std::string& file_name) const;
+
+	// Writes the remaining tests and the final counters to the streamed JUnit report.
+	void finish_junit_report();
+
+	// Writes the pending test cases to the streamed JUnit report in case those have waited
+	// for the flush period. Called periodically while waiting for the tests to complete, so
+	// that the results get to the file also when no test completes for a long time.
+	// Returns number of milliseconds till the next call is needed. Thread safe.
+	uint32_t flush_junit_if_due();
+
+	bool is_junit_streamed() const noexcept
+	{
+		return this->junit.has_value();
+	}
 };
 
 } // namespace tst
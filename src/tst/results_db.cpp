@@ -0,0 +1,366 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "results_db.hxx"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <utki/debug.hpp>
+#include <utki/util.hpp>
+
+#if CFG_OS != CFG_OS_WINDOWS
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+using namespace tst;
+
+namespace {
+constexpr const std::array<char, 8> magic = {'t', 's', 't', 'r', 'e', 's', 'd', 'b'};
+} // namespace
+
+results_db::mapped_file::~mapped_file()
+{
+#if CFG_OS != CFG_OS_WINDOWS
+	if (this->data) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+		munmap(const_cast<uint8_t*>(this->data), this->size);
+	}
+#endif
+}
+
+bool results_db::mapped_file::open(const std::string& file_name)
+{
+	ASSERT(!this->data)
+
+#if CFG_OS == CFG_OS_WINDOWS
+	std::ifstream f(file_name, std::ios::binary);
+	if (!f.is_open()) {
+		return false;
+	}
+	this->buffer.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+	this->data = this->buffer.data();
+	this->size = this->buffer.size();
+#else
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+	int fd = ::open(file_name.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	utki::scope_exit fd_scope_exit([fd]() {
+		::close(fd);
+	});
+
+	struct stat st = {};
+	if (fstat(fd, &st) != 0) {
+		throw std::runtime_error("results_db: fstat() failed");
+	}
+
+	if (st.st_size == 0) {
+		return true;
+	}
+
+	void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) {
+		throw std::runtime_error("results_db: mmap() failed");
+	}
+	this->data = static_cast<const uint8_t*>(p);
+	this->size = size_t(st.st_size);
+#endif
+
+	return true;
+}
+
+void results_db::open(const std::string& file_name)
+{
+	if (!this->file.open(file_name)) {
+		return;
+	}
+
+	auto bytes = this->file.span();
+	if (bytes.empty()) {
+		return;
+	}
+
+	auto throw_corrupted = [&file_name]() {
+		std::stringstream ss;
+		ss << "results database file '" << file_name << "' is corrupted or has unsupported format";
+		throw std::invalid_argument(ss.str());
+	};
+
+	if (bytes.size() < sizeof(header)) {
+		throw_corrupted();
+	}
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	const auto& h = *reinterpret_cast<const header*>(bytes.data());
+
+	if (h.magic != magic || h.version != version || h.depth == 0) {
+		throw_corrupted();
+	}
+
+	// the header values are not trusted, so the sizes are checked without overflowing
+	size_t payload_size = bytes.size() - sizeof(header);
+
+	if (h.depth > (std::numeric_limits<size_t>::max() - sizeof(record)) / sizeof(run_info)) {
+		throw_corrupted();
+	}
+	size_t rec_size = sizeof(record) + sizeof(run_info) * h.depth;
+
+	if (h.num_records > payload_size / rec_size) {
+		throw_corrupted();
+	}
+	size_t records_size = rec_size * size_t(h.num_records);
+
+	if (h.strings_size != payload_size - records_size) {
+		throw_corrupted();
+	}
+
+	this->hdr = &h;
+	this->records_begin = bytes.data() + sizeof(header);
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	this->strings = reinterpret_cast<const char*>(this->records_begin + records_size);
+
+	for (size_t i = 0; i != this->size(); ++i) {
+		const auto& r = this->get_record(i);
+		if (r.num_runs > h.depth || //
+			uint64_t(r.suite_offset) + r.suite_size > h.strings_size ||
+			uint64_t(r.test_offset) + r.test_size > h.strings_size)
+		{
+			this->hdr = nullptr;
+			throw_corrupted();
+		}
+	}
+}
+
+size_t results_db::record_size() const noexcept
+{
+	ASSERT(this->hdr)
+	return sizeof(record) + sizeof(run_info) * this->hdr->depth;
+}
+
+const results_db::record& results_db::get_record(size_t index) const noexcept
+{
+	ASSERT(index < this->size())
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	return *reinterpret_cast<const record*>(this->records_begin + this->record_size() * index);
+}
+
+std::string_view results_db::get_string(uint32_t offset, uint32_t size) const noexcept
+{
+	return {this->strings + offset, size};
+}
+
+std::string_view results_db::suite(size_t index) const noexcept
+{
+	const auto& r = this->get_record(index);
+	return this->get_string(r.suite_offset, r.suite_size);
+}
+
+std::string_view results_db::test(size_t index) const noexcept
+{
+	const auto& r = this->get_record(index);
+	return this->get_string(r.test_offset, r.test_size);
+}
+
+utki::span<const results_db::run_info> results_db::runs(size_t index) const noexcept
+{
+	const auto& r = this->get_record(index);
+	return utki::make_span(
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		reinterpret_cast<const run_info*>(&r + 1),
+		r.num_runs
+	);
+}
+
+std::optional<size_t> results_db::find(std::string_view suite, std::string_view test) const noexcept
+{
+	size_t begin = 0;
+	size_t end = this->size();
+
+	while (begin != end) {
+		size_t mid = begin + (end - begin) / 2;
+		auto key = std::make_tuple(this->suite(mid), this->test(mid));
+		auto value = std::make_tuple(suite, test);
+		if (key == value) {
+			return mid;
+		}
+		if (key < value) {
+			begin = mid + 1;
+		} else {
+			end = mid;
+		}
+	}
+
+	return {};
+}
+
+namespace {
+class writer
+{
+	std::ofstream& f;
+
+public:
+	writer(std::ofstream& f) :
+		f(f)
+	{}
+
+	template <class object_type>
+	void write(const object_type& o)
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		this->f.write(reinterpret_cast<const char*>(&o), sizeof(o));
+	}
+};
+} // namespace
+
+void results_db::write(const std::string& file_name, uint32_t depth, const std::vector<entry>& new_results) const
+{
+	ASSERT(depth != 0)
+	ASSERT(std::is_sorted(new_results.begin(), new_results.end(), [](const auto& a, const auto& b) {
+		return std::make_tuple(a.suite, a.test) < std::make_tuple(b.suite, b.test);
+	}))
+
+	struct out_record {
+		std::string_view suite;
+		std::string_view test;
+		std::vector<run_info> runs;
+	};
+
+	// merge old records with new results
+	std::vector<out_record> records;
+	records.reserve(std::max(this->size(), new_results.size()));
+
+	auto add_old_runs = [this, depth](out_record& r, size_t index) {
+		for (const auto& run : this->runs(index)) {
+			if (r.runs.size() == depth) {
+				break;
+			}
+			r.runs.push_back(run);
+		}
+	};
+
+	size_t oi = 0;
+	auto ni = new_results.begin();
+	while (oi != this->size() || ni != new_results.end()) {
+		if (ni == new_results.end() ||
+			(oi != this->size() &&
+			 std::make_tuple(this->suite(oi), this->test(oi)) < std::make_tuple(ni->suite, ni->test)))
+		{
+			records.push_back({this->suite(oi), this->test(oi), {}});
+			add_old_runs(records.back(), oi);
+			++oi;
+			continue;
+		}
+
+		records.push_back({ni->suite, ni->test, {ni->run}});
+		if (oi != this->size() && this->suite(oi) == ni->suite && this->test(oi) == ni->test) {
+			add_old_runs(records.back(), oi);
+			++oi;
+		}
+		++ni;
+	}
+
+	// build string table, suite names are stored only once
+	std::string strings;
+	std::vector<record> file_records;
+	file_records.reserve(records.size());
+	{
+		std::string_view last_suite;
+		uint32_t last_suite_offset = 0;
+		for (const auto& r : records) {
+			if (file_records.empty() || r.suite != last_suite) {
+				last_suite = r.suite;
+				last_suite_offset = uint32_t(strings.size());
+				strings.append(r.suite);
+			}
+			record fr{};
+			fr.suite_offset = last_suite_offset;
+			fr.suite_size = uint32_t(r.suite.size());
+			fr.test_offset = uint32_t(strings.size());
+			fr.test_size = uint32_t(r.test.size());
+			fr.num_runs = uint32_t(r.runs.size());
+			strings.append(r.test);
+			file_records.push_back(fr);
+		}
+	}
+
+	std::string tmp_file_name = file_name + ".tmp";
+	{
+		std::ofstream f(tmp_file_name, std::ios::binary);
+		if (!f.is_open()) {
+			std::stringstream ss;
+			ss << "could not open results database file '" << tmp_file_name << "' for writing";
+			throw std::runtime_error(ss.str());
+		}
+
+		writer w(f);
+
+		header h{};
+		h.magic = magic;
+		h.version = version;
+		h.depth = depth;
+		h.num_records = records.size();
+		h.strings_size = strings.size();
+		w.write(h);
+
+		for (size_t i = 0; i != records.size(); ++i) {
+			w.write(file_records[i]);
+			for (uint32_t j = 0; j != depth; ++j) {
+				w.write(j < records[i].runs.size() ? records[i].runs[j] : run_info{});
+			}
+		}
+
+		f.write(strings.data(), std::streamsize(strings.size()));
+
+		f.flush();
+		if (!f.good()) {
+			std::stringstream ss;
+			ss << "could not write results database file '" << tmp_file_name << "'";
+			throw std::runtime_error(ss.str());
+		}
+	}
+
+	if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+		// on some systems rename does not replace existing file
+		std::remove(file_name.c_str());
+		if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+			std::stringstream ss;
+			ss << "could not replace results database file '" << file_name << "'";
+			throw std::runtime_error(ss.str());
+		}
+	}
+}
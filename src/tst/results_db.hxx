@@ -0,0 +1,201 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <utki/config.hpp>
+#include <utki/span.hpp>
+
+namespace tst {
+
+/**
+ * @brief Persistent test results database.
+ * The database is a compact binary file which holds the results of the last
+ * several runs of each test. The file is memory-mapped for reading, so that
+ * looking up the test history is cheap.
+ *
+ * File layout, all numbers are in host byte order:
+ * - header
+ * - records sorted by suite name and then by test name
+ * - string table with suite and test names
+ *
+ * Each record is followed by 'depth' number of run_info entries, newest run
+ * first, only 'num_runs' of which are valid.
+ */
+class results_db
+{
+public:
+	struct header {
+		std::array<char, 8> magic;
+		uint32_t version;
+		uint32_t depth;
+		uint64_t num_records;
+		uint64_t strings_size;
+	};
+
+	struct record {
+		uint32_t suite_offset;
+		uint32_t suite_size;
+		uint32_t test_offset;
+		uint32_t test_size;
+		uint32_t num_runs;
+		uint32_t reserved;
+	};
+
+	struct run_info {
+		// seconds since epoch
+		int64_t timestamp;
+		uint32_t duration_ms;
+		uint8_t status;
+		std::array<uint8_t, 3> reserved;
+	};
+
+	static_assert(sizeof(header) == 32, "unexpected results_db::header size");
+	static_assert(sizeof(record) == 24, "unexpected results_db::record size");
+	static_assert(sizeof(run_info) == 16, "unexpected results_db::run_info size");
+
+	/**
+	 * @brief Test result to add to the database.
+	 */
+	struct entry {
+		std::string_view suite;
+		std::string_view test;
+		run_info run;
+	};
+
+private:
+	class mapped_file
+	{
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+#if CFG_OS == CFG_OS_WINDOWS
+		std::vector<uint8_t> buffer;
+#endif
+
+	public:
+		mapped_file() = default;
+
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+
+		mapped_file(mapped_file&&) = delete;
+		mapped_file& operator=(mapped_file&&) = delete;
+
+		~mapped_file();
+
+		// returns false if file does not exist
+		bool open(const std::string& file_name);
+
+		utki::span<const uint8_t> span() const noexcept
+		{
+			return utki::make_span(this->data, this->size);
+		}
+	};
+
+	mapped_file file;
+
+	const header* hdr = nullptr;
+	const uint8_t* records_begin = nullptr;
+	const char* strings = nullptr;
+
+	size_t record_size() const noexcept;
+
+	const record& get_record(size_t index) const noexcept;
+
+	std::string_view get_string(uint32_t offset, uint32_t size) const noexcept;
+
+public:
+	constexpr static const uint32_t version = 1;
+
+	results_db() = default;
+
+	results_db(const results_db&) = delete;
+	results_db& operator=(const results_db&) = delete;
+
+	results_db(results_db&&) = delete;
+	results_db& operator=(results_db&&) = delete;
+
+	~results_db() = default;
+
+	/**
+	 * @brief Open the database file.
+	 * In case the file does not exist, the database remains empty.
+	 * @param file_name - database file name.
+	 * @throw std::invalid_argument - in case the file is corrupted or has unsupported format.
+	 */
+	void open(const std::string& file_name);
+
+	/**
+	 * @brief Get number of test records.
+	 */
+	size_t size() const noexcept
+	{
+		if (!this->hdr) {
+			return 0;
+		}
+		return size_t(this->hdr->num_records);
+	}
+
+	std::string_view suite(size_t index) const noexcept;
+	std::string_view test(size_t index) const noexcept;
+
+	/**
+	 * @brief Get test runs history.
+	 * @param index - index of the test record.
+	 * @return test runs, newest first.
+	 */
+	utki::span<const run_info> runs(size_t index) const noexcept;
+
+	/**
+	 * @brief Find test record.
+	 * @param suite - test suite name.
+	 * @param test - test case name.
+	 * @return index of the test record, if found.
+	 */
+	std::optional<size_t> find(std::string_view suite, std::string_view test) const noexcept;
+
+	/**
+	 * @brief Write database file.
+	 * Writes the database file, containing the history from the currently
+	 * opened database with the new test results added.
+	 * The file is first written to a temporary file which then replaces the
+	 * database file, so that the concurrent readers are not affected.
+	 * @param file_name - database file name.
+	 * @param depth - maximum number of runs to keep per test.
+	 * @param new_results - results of the current run, sorted by suite and test names.
+	 */
+	void write(const std::string& file_name, uint32_t depth, const std::vector<entry>& new_results) const;
+};
+
+} // namespace tst
@@ -28,25 +28,28 @@ SOFTWARE.
 
 #	include "runners_pool.hxx"
 
-#	include "settings.hxx"
-
 using namespace tst;
 
-runner* runners_pool::occupy_runner()
+runners_pool::runners_pool(size_t num_runners)
 {
-	if (!this->free_runners.empty()) {
-		auto r = this->free_runners.back();
-		ASSERT(r)
-		this->free_runners.pop_back();
-		return r;
-	} else if (this->runners.size() != settings::inst().num_threads) {
-		ASSERT(this->runners.size() < settings::inst().num_threads)
+	this->runners.reserve(num_runners);
+	for (size_t i = 0; i != num_runners; ++i) {
 		this->runners.push_back(std::make_unique<runner>());
-		auto r = this->runners.back().get();
-		r->start();
-		return r;
+		this->runners.back()->start();
 	}
-	return nullptr;
+}
+
+void runners_pool::abandon(size_t index)
+{
+	ASSERT(index < this->runners.size())
+	auto& r = this->runners[index];
+
+	// The thread object cannot be destroyed while its thread is running,
+	// so the runner is intentionally leaked.
+	[[maybe_unused]] auto abandoned = r.release();
+
+	r = std::make_unique<runner>();
+	r->start();
 }
 
 #endif // ~TST_NO_PAR
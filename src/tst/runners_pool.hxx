@@ -26,7 +26,7 @@ SOFTWARE.
 
 #pragma once
 
-#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include <utki/debug.hpp>
@@ -38,17 +38,14 @@ namespace tst {
 class runners_pool
 {
 	std::vector<std::unique_ptr<runner>> runners;
-	std::vector<runner*> free_runners;
 
 public:
-	void stop_all_runners()
-	{
-		for (auto& r : this->runners) {
-			r->quit();
-		}
-	}
-
-	runners_pool() = default;
+	/**
+	 * @brief Constructor.
+	 * Creates and starts the requested number of runners.
+	 * @param num_runners - number of runners to start.
+	 */
+	runners_pool(size_t num_runners);
 
 	runners_pool(const runners_pool&) = delete;
 	runners_pool& operator=(const runners_pool&) = delete;
@@ -63,26 +60,31 @@ public:
 		}
 	}
 
-	void free_runner(runner* r)
+	void stop_all_runners()
 	{
-		utki::run_debug([&]() {
-			auto i = std::find(this->free_runners.begin(), this->free_runners.end(), r);
-			utki::assert(
-				i == this->free_runners.end(),
-				[](auto& o) {
-					o << "runner is already freed";
-				},
-				SL
-			);
-		});
-		this->free_runners.push_back(r);
+		for (auto& r : this->runners) {
+			r->quit();
+		}
 	}
 
-	runner* occupy_runner();
+	/**
+	 * @brief Replace the runner with a new one.
+	 * The old runner is left running and is never joined nor destroyed.
+	 * This is used to get rid of a runner which is stuck in a hung test.
+	 * @param index - index of the runner to abandon.
+	 */
+	void abandon(size_t index);
+
+	size_t size() const noexcept
+	{
+		return this->runners.size();
+	}
 
-	bool no_active_runners() const noexcept
+	runner& get(size_t index)
 	{
-		return this->runners.size() == this->free_runners.size();
+		ASSERT(index < this->runners.size())
+		ASSERT(this->runners[index])
+		return *this->runners[index];
 	}
 };
 
@@ -0,0 +1,341 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "scheduler.hxx"
+
+#include <algorithm>
+
+#include <utki/debug.hpp>
+
+using namespace tst;
+
+scheduler::scheduler(size_t num_workers) :
+	queues(num_workers)
+{
+	ASSERT(num_workers != 0)
+}
+
+void scheduler::distribute(const std::vector<size_t>& tasks)
+{
+	for (size_t i = 0; i != tasks.size(); ++i) {
+		this->queues[i % this->queues.size()].tasks.push_back(tasks[i]);
+	}
+	this->num_tasks += tasks.size();
+}
+
+void scheduler::set_task_requirements(std::vector<requirements> task_requirements, const budgets& limits)
+{
+	ASSERT(limits.cpu != 0)
+
+	size_t num_resources = 0;
+	for (auto& r : task_requirements) {
+		for (auto i : r.resources) {
+			num_resources = std::max(num_resources, i + 1);
+		}
+		r.cpu_weight = std::min(r.cpu_weight, limits.cpu);
+		r.memory_weight = std::min(r.memory_weight, limits.memory);
+	}
+
+	this->task_requirements = std::move(task_requirements);
+	this->limits = limits;
+	this->busy_resources.assign(num_resources, false);
+	this->resource_waiters.assign(num_resources, {});
+}
+
+size_t scheduler::find_busy_resource(size_t task) const
+{
+	const auto& r = this->task_requirements[task];
+
+	auto i = std::find_if(r.resources.begin(), r.resources.end(), [this](size_t i) {
+		return this->busy_resources[i];
+	});
+	if (i == r.resources.end()) {
+		return no_resource;
+	}
+	return *i;
+}
+
+bool scheduler::acquire(size_t task)
+{
+	const auto& r = this->task_requirements[task];
+
+	if (this->find_busy_resource(task) != no_resource) {
+		return false;
+	}
+
+	auto fits = [this](size_t cpu, size_t memory) {
+		return this->used_cpu + cpu <= this->limits.cpu && this->used_memory + memory <= this->limits.memory;
+	};
+
+	if (this->reserved_task != no_task && this->reserved_task != task) {
+		const auto& rr = this->task_requirements[this->reserved_task];
+		if (!fits(r.cpu_weight + rr.cpu_weight, r.memory_weight + rr.memory_weight)) {
+			return false;
+		}
+	} else if (!fits(r.cpu_weight, r.memory_weight)) {
+		// reserve the weights, so that the task is not starved by lighter tasks
+		this->reserved_task = task;
+		return false;
+	}
+
+	if (this->reserved_task == task) {
+		this->reserved_task = no_task;
+	}
+
+	for (auto i : r.resources) {
+		this->busy_resources[i] = true;
+	}
+	this->used_cpu += r.cpu_weight;
+	this->used_memory += r.memory_weight;
+
+	return true;
+}
+
+void scheduler::release(size_t task)
+{
+	const auto& r = this->task_requirements[task];
+
+	for (auto i : r.resources) {
+		ASSERT(this->busy_resources[i])
+		this->busy_resources[i] = false;
+
+		// the waiting tasks will be tried again
+		auto& waiters = this->resource_waiters[i];
+		this->ready_tasks.insert(this->ready_tasks.end(), waiters.begin(), waiters.end());
+		waiters.clear();
+	}
+
+	ASSERT(this->used_cpu >= r.cpu_weight)
+	this->used_cpu -= r.cpu_weight;
+	ASSERT(this->used_memory >= r.memory_weight)
+	this->used_memory -= r.memory_weight;
+}
+
+void scheduler::notify()
+{
+	{
+		std::lock_guard<decltype(this->admission_mutex)> lock_guard(this->admission_mutex);
+		++this->generation;
+	}
+	this->generation_cv.notify_all();
+}
+
+void scheduler::push_front(size_t worker, size_t task)
+{
+	ASSERT(worker < this->queues.size())
+	auto& q = this->queues[worker];
+	{
+		std::lock_guard<decltype(q.mutex)> lock_guard(q.mutex);
+		q.tasks.push_front(task);
+		++this->num_tasks;
+	}
+
+	if (this->has_requirements()) {
+		std::lock_guard<decltype(this->admission_mutex)> lock_guard(this->admission_mutex);
+		this->release(task);
+	}
+
+	this->notify();
+}
+
+void scheduler::done(size_t task)
+{
+	if (!this->has_requirements()) {
+		return;
+	}
+
+	{
+		std::lock_guard<decltype(this->admission_mutex)> lock_guard(this->admission_mutex);
+		this->release(task);
+	}
+
+	this->notify();
+}
+
+std::vector<size_t> scheduler::abandon(size_t task)
+{
+	if (!this->has_requirements()) {
+		return {};
+	}
+
+	// lock all the deques, so that no task is moved between deques and wait lists while removing
+	std::vector<std::unique_lock<std::mutex>> queue_locks;
+	queue_locks.reserve(this->queues.size());
+	for (auto& q : this->queues) {
+		queue_locks.emplace_back(q.mutex);
+	}
+
+	std::vector<size_t> removed;
+
+	{
+		std::lock_guard<decltype(this->admission_mutex)> lock_guard(this->admission_mutex);
+
+		// the abandoned task is replaced by a new worker, so its weights are not charged against the budgets anymore
+		const auto& ar = this->task_requirements[task];
+		ASSERT(this->used_cpu >= ar.cpu_weight)
+		this->used_cpu -= ar.cpu_weight;
+		ASSERT(this->used_memory >= ar.memory_weight)
+		this->used_memory -= ar.memory_weight;
+
+		auto needs_abandoned_resource = [&](size_t t) {
+			const auto& r = this->task_requirements[t];
+			if (std::none_of(r.resources.begin(), r.resources.end(), [&ar](size_t i) {
+					return std::find(ar.resources.begin(), ar.resources.end(), i) != ar.resources.end();
+				}))
+			{
+				return false;
+			}
+
+			if (this->reserved_task == t) {
+				this->reserved_task = no_task;
+			}
+			removed.push_back(t);
+			return true;
+		};
+
+		auto remove_tasks = [&needs_abandoned_resource](auto& tasks) {
+			tasks.erase(std::remove_if(tasks.begin(), tasks.end(), needs_abandoned_resource), tasks.end());
+		};
+
+		for (auto& q : this->queues) {
+			remove_tasks(q.tasks);
+		}
+		remove_tasks(this->ready_tasks);
+		for (auto& waiters : this->resource_waiters) {
+			remove_tasks(waiters);
+		}
+
+		this->num_tasks -= removed.size();
+	}
+
+	queue_locks.clear();
+
+	// wake up the workers waiting for the removed tasks to be admitted or for the weights to be released
+	this->notify();
+
+	return removed;
+}
+
+std::optional<size_t> scheduler::take_admissible(std::deque<size_t>& tasks)
+{
+	std::optional<size_t> ret;
+
+	// tasks which stay in the deque are gathered at the beginning of the scanned range
+	auto kept_end = tasks.begin();
+	auto i = tasks.begin();
+	for (; i != tasks.end(); ++i) {
+		auto task = *i;
+
+		auto busy_resource = this->find_busy_resource(task);
+		if (busy_resource != no_resource) {
+			this->resource_waiters[busy_resource].push_back(task);
+			continue;
+		}
+
+		if (this->acquire(task)) {
+			ret = task;
+			--this->num_tasks;
+			++i;
+			break;
+		}
+
+		*kept_end = task;
+		++kept_end;
+	}
+
+	// remove the taken and the waiting tasks by shifting the kept ones towards the unscanned tasks,
+	// so that the cost is proportional to the number of scanned tasks
+	auto kept_begin = std::move_backward(tasks.begin(), kept_end, i);
+	tasks.erase(tasks.begin(), kept_begin);
+
+	return ret;
+}
+
+std::optional<size_t> scheduler::take(worker_queue& q)
+{
+	std::lock_guard<decltype(q.mutex)> lock_guard(q.mutex);
+
+	if (!this->has_requirements()) {
+		if (q.tasks.empty()) {
+			return {};
+		}
+		auto task = q.tasks.front();
+		q.tasks.pop_front();
+		--this->num_tasks;
+		return task;
+	}
+
+	std::lock_guard<decltype(this->admission_mutex)> admission_lock_guard(this->admission_mutex);
+	return this->take_admissible(q.tasks);
+}
+
+std::optional<size_t> scheduler::try_pop(size_t worker)
+{
+	ASSERT(worker < this->queues.size())
+
+	// tasks which have waited for a resource go first, as those were taken from deques earlier
+	if (this->has_requirements()) {
+		std::lock_guard<decltype(this->admission_mutex)> lock_guard(this->admission_mutex);
+		if (auto t = this->take_admissible(this->ready_tasks)) {
+			return t;
+		}
+	}
+
+	// try own deque first, then steal from peers
+	for (size_t i = 0; i != this->queues.size(); ++i) {
+		auto& q = this->queues[(worker + i) % this->queues.size()];
+		if (auto t = this->take(q)) {
+			return t;
+		}
+	}
+
+	return {};
+}
+
+std::optional<size_t> scheduler::pop(size_t worker)
+{
+	for (;;) {
+		size_t gen = 0;
+		{
+			std::lock_guard<decltype(this->admission_mutex)> lock_guard(this->admission_mutex);
+			gen = this->generation;
+		}
+
+		if (auto t = this->try_pop(worker)) {
+			return t;
+		}
+
+		if (this->num_tasks == 0) {
+			return {};
+		}
+
+		// none of the tasks left can be admitted, wait till some requirements are released
+		std::unique_lock<decltype(this->admission_mutex)> lock(this->admission_mutex);
+		this->generation_cv.wait(lock, [this, gen]() {
+			return this->generation != gen;
+		});
+	}
+}
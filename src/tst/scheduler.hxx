@@ -0,0 +1,236 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace tst {
+
+/**
+ * @brief Work stealing tasks scheduler.
+ * Each worker owns a deque of task indices. A worker takes tasks from
+ * its own deque and, when it runs empty, steals tasks from its peers.
+ * Tasks are always taken from the front of a deque, both by the owner and by
+ * the thieves, so the order in which the tasks were pushed is respected as
+ * much as possible.
+ * Tasks can have requirements: exclusive resources and CPU and memory weights.
+ * A task is not given to a worker while any of its resources is used by another
+ * task or while its weights do not fit into the budgets, instead, the next task
+ * from the deque is taken. A task waiting for a resource is moved out of the deque
+ * to the wait list of the resource, so that it is not scanned again until the
+ * resource is released. In order to not starve heavy tasks, the first task
+ * which does not fit into the budgets reserves its weights, so that other tasks
+ * are only taken if they fit into the budgets along with the reserved weights.
+ */
+class scheduler
+{
+public:
+	/**
+	 * @brief Task requirements.
+	 */
+	struct requirements {
+		/**
+		 * @brief Indices of exclusive resources.
+		 */
+		std::vector<size_t> resources;
+
+		/**
+		 * @brief Number of CPU budget units used by the task.
+		 */
+		size_t cpu_weight = 1;
+
+		/**
+		 * @brief Number of memory budget units used by the task.
+		 */
+		size_t memory_weight = 0;
+	};
+
+	/**
+	 * @brief Budgets for sum of weights of concurrently running tasks.
+	 */
+	struct budgets {
+		size_t cpu = std::numeric_limits<size_t>::max();
+		size_t memory = std::numeric_limits<size_t>::max();
+	};
+
+private:
+	struct worker_queue {
+		std::mutex mutex;
+		std::deque<size_t> tasks;
+	};
+
+	std::vector<worker_queue> queues;
+
+	// number of tasks in all the deques and wait lists
+	std::atomic<size_t> num_tasks{0};
+
+	// requirements of each task, empty if tasks have no requirements
+	std::vector<requirements> task_requirements;
+
+	budgets limits;
+
+	constexpr static const size_t no_task = std::numeric_limits<size_t>::max();
+	constexpr static const size_t no_resource = std::numeric_limits<size_t>::max();
+
+	// state of task admission, guarded by admission_mutex
+	std::mutex admission_mutex;
+	std::vector<bool> busy_resources;
+
+	// tasks waiting for a busy resource, per resource
+	std::vector<std::vector<size_t>> resource_waiters;
+
+	// tasks which were waiting for a resource which has been released since
+	std::deque<size_t> ready_tasks;
+	size_t used_cpu = 0;
+	size_t used_memory = 0;
+	size_t reserved_task = no_task;
+
+	// incremented each time requirements are released or tasks are returned to deques
+	size_t generation = 0;
+	std::condition_variable generation_cv;
+
+	// returns index of a resource of the task which is used by another task,
+	// must be called with admission_mutex locked
+	size_t find_busy_resource(size_t task) const;
+
+	// returns false if the task cannot be admitted now, must be called with admission_mutex locked
+	bool acquire(size_t task);
+
+	// must be called with admission_mutex locked
+	void release(size_t task);
+
+	void notify();
+
+	// takes first task which can be admitted, tasks waiting for a resource are moved to the wait lists,
+	// must be called with admission_mutex locked
+	std::optional<size_t> take_admissible(std::deque<size_t>& tasks);
+
+	std::optional<size_t> take(worker_queue& q);
+
+public:
+	scheduler(size_t num_workers);
+
+	scheduler(const scheduler&) = delete;
+	scheduler& operator=(const scheduler&) = delete;
+
+	scheduler(scheduler&&) = delete;
+	scheduler& operator=(scheduler&&) = delete;
+
+	~scheduler() = default;
+
+	size_t num_workers() const noexcept
+	{
+		return this->queues.size();
+	}
+
+	/**
+	 * @brief Check if tasks have requirements.
+	 * @return true if task requirements were set.
+	 */
+	bool has_requirements() const noexcept
+	{
+		return !this->task_requirements.empty();
+	}
+
+	/**
+	 * @brief Distribute tasks among workers.
+	 * Task indices are pushed to the workers' deques in round-robin manner.
+	 * Not thread safe, supposed to be called before the workers are started.
+	 * @param tasks - task indices to distribute.
+	 */
+	void distribute(const std::vector<size_t>& tasks);
+
+	/**
+	 * @brief Set requirements of the tasks.
+	 * No two tasks requiring the same resource are given to workers at the same time.
+	 * Sums of weights of the tasks given to workers at the same time do not exceed the budgets.
+	 * Weights exceeding the budgets are reduced to the budgets, so that such tasks run alone.
+	 * Not thread safe, supposed to be called before the workers are started.
+	 * @param task_requirements - requirements of each task.
+	 * @param limits - budgets for weights of the concurrently running tasks.
+	 */
+	void set_task_requirements(std::vector<requirements> task_requirements, const budgets& limits);
+
+	/**
+	 * @brief Return task to the worker's deque.
+	 * The task is pushed to the front of the deque, so it will be the next one
+	 * to be taken. Requirements of the task are released. Thread safe.
+	 * @param worker - index of the worker to return the task to.
+	 * @param task - index of the task.
+	 */
+	void push_front(size_t worker, size_t task);
+
+	/**
+	 * @brief Get next task for the worker.
+	 * Requirements of the task are acquired. In case none of the tasks left
+	 * can be admitted, waits until some requirements are released.
+	 * Thread safe.
+	 * @param worker - index of the worker requesting the task.
+	 * @return index of the task to run.
+	 * @return empty optional if there are no tasks left.
+	 */
+	std::optional<size_t> pop(size_t worker);
+
+	/**
+	 * @brief Get next task for the worker without waiting.
+	 * Same as pop(), but does not wait for requirements to be released.
+	 * Thread safe.
+	 * @param worker - index of the worker requesting the task.
+	 * @return index of the task to run.
+	 * @return empty optional if there are no tasks left or none of the tasks left can be admitted.
+	 */
+	std::optional<size_t> try_pop(size_t worker);
+
+	/**
+	 * @brief Notify that the task has completed.
+	 * Releases requirements of the task.
+	 * Thread safe.
+	 * @param task - index of the completed task.
+	 */
+	void done(size_t task);
+
+	/**
+	 * @brief Notify that the task will never complete.
+	 * The task is still running, so its resources are never released. Its worker
+	 * is supposed to be replaced by a new one, so the weights of the task are
+	 * released, same as if the task was done.
+	 * The tasks left which require a resource of the abandoned task can never
+	 * be admitted, so those are removed.
+	 * Thread safe.
+	 * @param task - index of the abandoned task.
+	 * @return indices of the removed tasks.
+	 */
+	std::vector<size_t> abandon(size_t task);
+};
+
+} // namespace tst
@@ -38,3 +38,13 @@ set::set(const std::string& suite_name, inits_type::value_type::second_type::val
 {
 	get_inits()[suite_name].push_back(std::move(init));
 }
+
+const static_set* static_set::head = nullptr;
+
+static_set::static_set(std::string_view suite_name, utki::span<const test_entry> tests) noexcept :
+	next(head),
+	suite_name(suite_name),
+	tests(tests)
+{
+	head = this;
+}
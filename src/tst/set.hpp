@@ -28,8 +28,11 @@ SOFTWARE.
 
 #include <functional>
 #include <map>
+#include <string_view>
 #include <vector>
 
+#include <utki/span.hpp>
+
 #include "suite.hpp"
 
 namespace tst {
@@ -61,4 +64,52 @@ public:
 	set(const std::string& suite_name, inits_type::value_type::second_type::value_type init);
 };
 
+/**
+ * @brief Test case set defined by a table.
+ * Unlike tst::set, the static set does not store any initializer function and
+ * does not allocate memory at program startup, so it is suitable for a large
+ * number of test cases. The table of test cases is supposed to be a constexpr
+ * array of plain test functions:
+ * @code
+ * constexpr tst::test_entry my_tests[] = {
+ *     {"first_test", &first_test},
+ *     {"second_test", &second_test},
+ * };
+ * const tst::static_set my_set("my_suite", my_tests);
+ * @endcode
+ * The test cases are added to the test suite only in case the suite is
+ * selected to run.
+ */
+class static_set
+{
+	friend class application;
+
+	// Static sets form a singly linked list. The head pointer is constant initialized,
+	// so the list can be used from constructors of global objects.
+	static const static_set* head;
+	const static_set* next;
+
+	std::string_view suite_name;
+	utki::span<const test_entry> tests;
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @param suite_name - name of the test suite to add the test cases to.
+	 *                     The string must outlive the static set object,
+	 *                     normally it is a string literal.
+	 * @param tests - table of test cases. The table must outlive the static set
+	 *                object, normally it is a global constexpr array.
+	 */
+	static_set(std::string_view suite_name, utki::span<const test_entry> tests) noexcept;
+
+	static_set(const static_set&) = delete;
+	static_set& operator=(const static_set&) = delete;
+
+	static_set(static_set&&) = delete;
+	static_set& operator=(static_set&&) = delete;
+
+	~static_set() = default;
+};
+
 } // namespace tst
@@ -26,6 +26,9 @@ SOFTWARE.
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include <utki/singleton.hpp>
 #include <utki/util.hpp>
 
@@ -44,6 +47,7 @@ public:
 
 	bool show_help = false;
 
+	bool list_suites = false;
 	bool list_tests = false;
 
 	bool run_disabled = false;
@@ -55,7 +59,38 @@ public:
 
 	unsigned long num_threads = 1;
 
+	bool jobs_in_processes = false;
+
+	// zero means unlimited
+	size_t memory_budget_mb = 0;
+
+	// zero means no timeout
+	uint32_t timeout_ms = 0;
+
+	uint32_t bench_time_ms = 100;
+	uint32_t bench_repetitions = 5;
+
+	std::string bench_baseline_file;
+	std::string bench_compare_file;
+
+	// allowed relative slowdown of benchmarks
+	double bench_threshold = 0.1;
+
+	// names of hardware performance counters to collect for each test
+	std::vector<std::string> perf_counters;
+
 	std::string junit_report_out_file;
+	bool junit_streaming = false;
+
+	std::string trace_out_file;
+
+	std::string timings_file;
+
+	size_t shard_index = 0;
+	size_t shard_count = 1;
+
+	std::string results_db_file;
+	uint32_t results_db_depth = 10;
 
 	bool run_list_stdin = false;
 
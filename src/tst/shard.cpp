@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "shard.hxx"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+using namespace tst;
+
+std::vector<bool> tst::select_shard(
+	const std::vector<iterator>& tests,
+	const timings& durations,
+	size_t shard_index,
+	size_t shard_count
+)
+{
+	ASSERT(shard_count != 0)
+	ASSERT(shard_index < shard_count)
+
+	std::vector<size_t> order(tests.size());
+	std::iota(order.begin(), order.end(), 0);
+
+	// sort by names to make partitioning independent of the registry order
+	std::sort(order.begin(), order.end(), [&tests](size_t a, size_t b) {
+		auto ia = tests[a].id();
+		auto ib = tests[b].id();
+		return std::tie(ia.suite, ia.test) < std::tie(ib.suite, ib.test);
+	});
+
+	std::vector<bool> ret(tests.size(), false);
+
+	if (durations.empty()) {
+		for (size_t i = shard_index; i < order.size(); i += shard_count) {
+			ret[order[i]] = true;
+		}
+		return ret;
+	}
+
+	std::vector<uint32_t> estimates;
+	estimates.reserve(tests.size());
+	for (const auto& t : tests) {
+		auto id = t.id();
+		estimates.push_back(t.info().flags.get(flag::disabled) ? 0 : durations.estimate(id.suite, id.test));
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&estimates](size_t a, size_t b) {
+		return estimates[a] > estimates[b];
+	});
+
+	struct shard_load {
+		uint64_t duration_ms = 0;
+		size_t num_tests = 0;
+	};
+
+	std::vector<shard_load> loads(shard_count);
+
+	for (auto t : order) {
+		// among shards with equal estimated duration choose the one with less tests,
+		// this balances the shards by number of tests in case estimates are zero
+		auto least_loaded = std::min_element(loads.begin(), loads.end(), [](const auto& a, const auto& b) {
+			return std::tie(a.duration_ms, a.num_tests) < std::tie(b.duration_ms, b.num_tests);
+		});
+
+		least_loaded->duration_ms += estimates[t];
+		++least_loaded->num_tests;
+
+		if (size_t(std::distance(loads.begin(), least_loaded)) == shard_index) {
+			ret[t] = true;
+		}
+	}
+
+	return ret;
+}
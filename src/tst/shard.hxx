@@ -0,0 +1,57 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <vector>
+
+#include "iterator.hxx"
+#include "timings.hxx"
+
+namespace tst {
+
+/**
+ * @brief Select tests belonging to a shard.
+ * Tests are partitioned among shards deterministically, so that each test
+ * belongs to exactly one shard, given that all shards are run with the same
+ * set of tests and the same test durations history.
+ * In case test durations history is available, the tests are assigned to shards
+ * longest first, each test to the least loaded shard, so that shards are balanced
+ * by estimated duration. Otherwise, the shards are balanced by number of tests.
+ * @param tests - tests to partition.
+ * @param durations - test durations history.
+ * @param shard_index - index of the shard to select tests for.
+ * @param shard_count - total number of shards.
+ * @return vector of flags indicating which tests belong to the shard.
+ */
+std::vector<bool> select_shard(
+	const std::vector<iterator>& tests,
+	const timings& durations,
+	size_t shard_index,
+	size_t shard_count
+);
+
+} // namespace tst
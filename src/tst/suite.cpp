@@ -26,46 +26,243 @@ SOFTWARE.
 
 #include "suite.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
 #include <utki/config.hpp>
 
+#include "benchmark.hxx"
 #include "settings.hxx"
 #include "util.hxx"
 
 using namespace tst;
 
-void suite::add(std::string id, utki::flags<flag> flags, std::function<void()> proc)
+namespace {
+void validate_properties(const properties& props)
+{
+	if (props.timeout.count() < 0) {
+		throw std::invalid_argument("test timeout is negative");
+	}
+
+	if (props.cpu_weight == 0) {
+		throw std::invalid_argument("test CPU weight is zero");
+	}
+
+	for (const auto& r : props.resources) {
+		if (r.empty()) {
+			throw std::invalid_argument("test resource name is empty");
+		}
+	}
+}
+} // namespace
+
+void suite::test_info::run(size_t param_index) const
+{
+	if (auto p = std::get_if<void (*)()>(&this->proc)) {
+		(*p)();
+	} else if (auto p = std::get_if<std::function<void()>>(&this->proc)) {
+		(*p)();
+	} else {
+		std::get<std::function<void(size_t)>>(this->proc)(param_index);
+	}
+}
+
+void suite::add_info(std::string id, utki::flags<flag> flags, const properties& props, test_info info)
 {
 	validate_id(id);
+	validate_properties(props);
+
+	if (settings::inst().run_disabled) {
+		flags.clear(flag::disabled);
+	}
 
+	info.id = this->ids.emplace_back(std::move(id));
+	info.flags = flags;
+	info.props = props;
+
+	this->num_tests += info.num_tests;
+
+	// duplicate ids are detected when the registration is finished, see sort_tests()
+	this->tests.push_back(std::move(info));
+}
+
+void suite::add(std::string id, utki::flags<flag> flags, const properties& props, std::function<void()> proc)
+{
 	if (!proc) {
 		throw std::invalid_argument("test procedure is nullptr");
 	}
 
-	if (settings::inst().run_disabled) {
-		flags.clear(flag::disabled);
+	test_info info;
+	info.proc = std::move(proc);
+	this->add_info(std::move(id), flags, props, std::move(info));
+}
+
+void suite::add_parametrized(
+	std::string id,
+	utki::flags<flag> flags,
+	const properties& props,
+	size_t num_params,
+	std::function<void(size_t)> proc
+)
+{
+	test_info info;
+	info.is_parametrized = true;
+	info.num_tests = num_params;
+	info.proc = std::move(proc);
+	this->add_info(std::move(id), flags, props, std::move(info));
+}
+
+void suite::add(utki::span<const test_entry> tests)
+{
+	this->tests.reserve(this->tests.size() + tests.size());
+	for (const auto& t : tests) {
+		validate_id(t.id);
+
+		if (!t.proc) {
+			throw std::invalid_argument("test procedure is nullptr");
+		}
+
+		// the test info refers to the table entry, which is supposed to be static
+		test_info info;
+		info.id = t.id;
+		info.proc = t.proc;
+
+		++this->num_tests;
+		this->tests.push_back(std::move(info));
 	}
+}
+
+namespace {
+// Splits id of a parametrized test case to the id of the parametrized test case and the parameter index.
+// Returns empty optional in case the id is not composed as by suite::make_indexed_id().
+std::optional<std::pair<std::string_view, size_t>> parse_indexed_id(std::string_view id)
+{
+	if (id.empty() || id.back() != ']') {
+		return {};
+	}
+
+	auto open = id.rfind('[');
+	if (open == std::string_view::npos) {
+		return {};
+	}
+
+	auto digits = id.substr(open + 1, id.size() - open - 2);
+	if (digits.empty() || (digits.size() > 1 && digits.front() == '0')) {
+		return {};
+	}
+
+	size_t index = 0;
+	for (auto c : digits) {
+		constexpr auto decimal_base = 10;
+		if (c < '0' || '9' < c || index > (std::numeric_limits<size_t>::max() - 9) / decimal_base) {
+			return {};
+		}
+		index = index * decimal_base + size_t(c - '0');
+	}
+
+	return std::make_pair(id.substr(0, open), index);
+}
+} // namespace
+
+namespace {
+// the tests are ordered by id, simple test case goes before parametrized test case with the same id
+bool is_test_less(std::string_view id_a, bool is_parametrized_a, std::string_view id_b, bool is_parametrized_b)
+{
+	return std::tie(id_a, is_parametrized_a) < std::tie(id_b, is_parametrized_b);
+}
+} // namespace
+
+void suite::sort_tests()
+{
+	std::sort(this->tests.begin(), this->tests.end(), [](const auto& a, const auto& b) {
+		return is_test_less(a.id, a.is_parametrized, b.id, b.is_parametrized);
+	});
 
-	if (this->tests.find(id) != this->tests.end()) {
+	auto throw_already_exists = [](std::string_view id) {
 		std::stringstream ss;
 		ss << "test with id = '" << id << "' already exists in the test suite";
 		throw std::invalid_argument(ss.str());
+	};
+
+	auto i = std::adjacent_find(this->tests.begin(), this->tests.end(), [](const auto& a, const auto& b) {
+		return a.id == b.id && a.is_parametrized == b.is_parametrized;
+	});
+	if (i != this->tests.end()) {
+		if (i->is_parametrized) {
+			throw_already_exists(make_indexed_id(i->id, 0));
+		}
+		throw_already_exists(i->id);
+	}
+
+	// simple test case can have same id as one of the parametrized test cases
+	for (const auto& t : this->tests) {
+		if (t.is_parametrized) {
+			continue;
+		}
+		auto [info, param_index] = this->find(t.id);
+		if (info != &t) {
+			throw_already_exists(t.id);
+		}
+	}
+}
+
+std::pair<const suite::test_info*, size_t> suite::find(std::string_view id) const
+{
+	auto find_info = [this](std::string_view id, bool is_parametrized) -> const test_info* {
+		auto i = std::lower_bound(
+			this->tests.begin(),
+			this->tests.end(),
+			id,
+			[is_parametrized](const auto& t, std::string_view id) {
+				return is_test_less(t.id, t.is_parametrized, id, is_parametrized);
+			}
+		);
+		if (i == this->tests.end() || i->id != id || i->is_parametrized != is_parametrized) {
+			return nullptr;
+		}
+		return &*i;
+	};
+
+	if (auto parsed = parse_indexed_id(id)) {
+		auto [parametrized_id, param_index] = parsed.value();
+		const auto* info = find_info(parametrized_id, true);
+		if (info && param_index < info->num_tests) {
+			return {info, param_index};
+		}
 	}
 
-#ifdef DEBUG
-	auto r =
-#endif
-		this->tests.insert(std::make_pair(
-			std::move(id),
-			// NOLINTNEXTLINE(modernize-use-designated-initializers)
-			test_info{std::move(proc), flags}
-		));
-	ASSERT(r.second)
+	return {find_info(id, false), 0};
 }
 
-void suite::add_disabled(std::string id, utki::flags<flag> flags, std::function<void()> proc)
+void suite::add_disabled(
+	std::string id,
+	utki::flags<flag> flags,
+	const properties& props,
+	std::function<void()> proc
+)
 {
 	flags.set(flag::disabled);
-	this->add(std::move(id), flags, std::move(proc));
+	this->add(std::move(id), flags, props, std::move(proc));
+}
+
+void suite::add_benchmark(
+	std::string id,
+	utki::flags<flag> flags,
+	const properties& props,
+	std::function<void(benchmark_state&)> proc
+)
+{
+	if (!proc) {
+		throw std::invalid_argument("benchmark procedure is nullptr");
+	}
+
+	this->add(std::move(id), flags, props, [proc = std::move(proc)]() {
+		benchmark_runner::run(proc);
+	});
+
+	ASSERT(!this->tests.empty())
+	this->tests.back().is_benchmark = true;
 }
 
 const char* suite::status_to_string(status s)
@@ -89,12 +286,13 @@ const char* suite::status_to_string(status s)
 
 std::string suite::make_indexed_id(std::string_view id, size_t index)
 {
-	std::stringstream ss;
-#if CFG_COMPILER == CFG_COMPILER_MSVC
-	ss << std::string(id);
-#else
-	ss << id;
-#endif
-	ss << "[" << index << "]";
-	return ss.str();
+	auto index_str = std::to_string(index);
+
+	std::string ret;
+	ret.reserve(id.size() + index_str.size() + 2);
+	ret.append(id);
+	ret.append(1, '[');
+	ret.append(index_str);
+	ret.append(1, ']');
+	return ret;
 }
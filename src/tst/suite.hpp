@@ -26,13 +26,25 @@ SOFTWARE.
 
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <sstream>
-#include <unordered_map>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include <utki/debug.hpp>
 #include <utki/flags.hpp>
+#include <utki/span.hpp>
+
+#include "alloc.hpp"
+#include "benchmark.hpp"
+#include "generator.hpp"
 
 namespace tst {
 
@@ -40,9 +52,72 @@ enum class flag {
 	disabled,
 	no_parallel,
 
+	/**
+	 * @brief The test is not thread safe.
+	 * When tests are run in parallel threads, such tests are run one by one after
+	 * all other tests, same as no_parallel tests. When tests are run in parallel
+	 * processes, see --jobs-mode=process, such tests are run in parallel.
+	 */
+	not_thread_safe,
+
 	enum_size
 };
 
+/**
+ * @brief Test case properties.
+ * Properties of a test case which are not simple on/off marks.
+ */
+struct properties {
+	/**
+	 * @brief Test case timeout.
+	 * In case the test case runs longer than the timeout it is reported as errored
+	 * and the rest of the tests continue to run. Zero value means that the
+	 * global timeout, see --timeout, is used for the test case.
+	 */
+	std::chrono::milliseconds timeout{0};
+
+	/**
+	 * @brief Names of exclusive resources used by the test case.
+	 * Test cases which use the same resource, for example a port range or a
+	 * temporary database, are never run at the same time. Apart from that,
+	 * such test cases are run in parallel with other test cases.
+	 */
+	std::vector<std::string> resources;
+
+	/**
+	 * @brief Number of CPU cores used by the test case.
+	 * For example, a test case which runs several threads should use a weight
+	 * equal to the number of threads. Sum of weights of the test cases running
+	 * at the same time does not exceed the number of parallel jobs, see --jobs.
+	 * A weight larger than the number of parallel jobs is reduced to it, so
+	 * such a test case is run alone. Must not be zero.
+	 */
+	unsigned cpu_weight = 1;
+
+	/**
+	 * @brief Memory used by the test case in megabytes.
+	 * Sum of weights of the test cases running at the same time does not
+	 * exceed the memory budget, see --memory-budget.
+	 */
+	size_t memory_weight_mb = 0;
+};
+
+/**
+ * @brief Entry of a test case table.
+ * Tables of test entries can be declared constexpr, see tst::static_set.
+ */
+struct test_entry {
+	/**
+	 * @brief Id of the test case.
+	 */
+	std::string_view id;
+
+	/**
+	 * @brief Test case procedure.
+	 */
+	void (*proc)();
+};
+
 /**
  * @brief Test suite.
  * The test suite object holds test case definitions belonging to a particular
@@ -52,6 +127,7 @@ class suite
 {
 	friend class application;
 	friend class reporter;
+	friend class tracer;
 	friend class iterator;
 
 	enum class status {
@@ -64,32 +140,82 @@ class suite
 
 	static const char* status_to_string(status s);
 
+	// Definition of a test case or, in case of a parametrized test case, of a range of test cases.
 	// TODO: why lint complains?
 	// "error: an exception may be thrown in function 'test_info'"
 	// NOLINTNEXTLINE(bugprone-exception-escape)
 	struct test_info {
-		std::function<void()> proc;
+		// Id of the test case. In case of a parametrized test case, the actual test case ids
+		// are composed of the id and '[index]' suffix, see make_indexed_id().
+		// Points to the test case table entry or to the suite's id storage.
+		std::string_view id;
+
+		bool is_parametrized = false;
+
+		// number of test cases in the range
+		size_t num_tests = 1;
+
+		// Test case procedure: plain function of a test case table entry, procedure of a simple
+		// test case or procedure of a parametrized test case which takes the parameter index.
+		std::variant<void (*)(), std::function<void()>, std::function<void(size_t)>> proc;
+
 		utki::flags<flag> flags;
+		properties props;
+
+		bool is_benchmark = false;
+
+		void run(size_t param_index) const;
+	};
+
+	// Result of a test case run, kept for each test case of the test table.
+	struct test_result {
 		mutable status result = status::not_run;
-		mutable uint32_t time_ms;
+		mutable uint32_t time_ms = 0;
 		mutable std::string message;
+
+		mutable std::optional<benchmark_result> benchmark;
+
+		// in the order of counters selected with --perf-counters
+		mutable std::vector<uint64_t> perf_counts;
+
+		// set in case the allocations are tracked, see alloc_hook.hpp
+		mutable std::optional<alloc_stats> allocs;
+
+		bool has_run() const noexcept
+		{
+			return this->result != status::not_run && this->result != status::disabled;
+		}
 	};
 
-	std::unordered_map<std::string, test_info> tests;
+	// Tests in order of registration. When the registration is finished the tests are
+	// sorted by id, see sort_tests().
+	std::vector<test_info> tests;
 
-	suite() = default;
+	// Storage of the test ids which do not come from test case tables.
+	// Elements of std::deque are not relocated when new elements are added.
+	std::deque<std::string> ids;
 
-	mutable size_t num_disabled = 0;
-	mutable size_t num_failed = 0;
-	mutable size_t num_passed = 0;
-	mutable size_t num_errors = 0;
+	// number of test cases, counting each test case of the parametrized test cases
+	size_t num_tests = 0;
 
-	size_t num_skipped() const noexcept
-	{
-		size_t num_non_skipped = this->num_disabled + this->num_errors + this->num_failed + this->num_passed;
-		ASSERT(this->tests.size() >= num_non_skipped)
-		return tests.size() - num_non_skipped;
-	}
+	void add_info(std::string id, utki::flags<flag> flags, const properties& props, test_info info);
+
+	void add_parametrized(
+		std::string id,
+		utki::flags<flag> flags,
+		const properties& props,
+		size_t num_params,
+		std::function<void(size_t)> proc
+	);
+
+	// throws std::invalid_argument in case there are tests with same id
+	void sort_tests();
+
+	// Tests must be sorted. Returns the test case definition and the parameter index.
+	// Returns nullptr definition in case the test is not found.
+	std::pair<const test_info*, size_t> find(std::string_view id) const;
+
+	suite() = default;
 
 	static std::string make_indexed_id(std::string_view id, size_t index);
 
@@ -108,16 +234,28 @@ public:
 	 */
 	size_t size() const noexcept
 	{
-		return this->tests.size();
+		return this->num_tests;
+	}
+
+	/**
+	 * @brief Add a simple test case to the test suite.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param proc - test case procedure.
+	 */
+	void add(std::string id, utki::flags<flag> flags, std::function<void()> proc)
+	{
+		this->add(std::move(id), flags, properties(), std::move(proc));
 	}
 
 	/**
 	 * @brief Add a simple test case to the test suite.
 	 * @param id - id of the test case.
 	 * @param flags - test marks.
+	 * @param props - test case properties.
 	 * @param proc - test case procedure.
 	 */
-	void add(std::string id, utki::flags<flag> flags, std::function<void()> proc);
+	void add(std::string id, utki::flags<flag> flags, const properties& props, std::function<void()> proc);
 
 	/**
 	 * @brief Add a simple test case to the test suite.
@@ -129,15 +267,35 @@ public:
 		this->add(std::move(id), false, std::move(proc));
 	}
 
+	/**
+	 * @brief Add simple test cases from a table to the test suite.
+	 * @param tests - table of the test cases to add.
+	 */
+	void add(utki::span<const test_entry> tests);
+
+	/**
+	 * @brief Add a simple disabled test case to the test suite.
+	 * This method is same as corresponding 'add()' method but it
+	 * implicitly adds a 'disabled' mark to the test case.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param proc - test case procedure.
+	 */
+	void add_disabled(std::string id, utki::flags<flag> flags, std::function<void()> proc)
+	{
+		this->add_disabled(std::move(id), flags, properties(), std::move(proc));
+	}
+
 	/**
 	 * @brief Add a simple disabled test case to the test suite.
 	 * This method is same as corresponding 'add()' method but it
 	 * implicitly adds a 'disabled' mark to the test case.
 	 * @param id - id of the test case.
 	 * @param flags - test marks.
+	 * @param props - test case properties.
 	 * @param proc - test case procedure.
 	 */
-	void add_disabled(std::string id, utki::flags<flag> flags, std::function<void()> proc);
+	void add_disabled(std::string id, utki::flags<flag> flags, const properties& props, std::function<void()> proc);
 
 	/**
 	 * @brief Add a simple disabled test case to the test suite.
@@ -151,6 +309,45 @@ public:
 		this->add_disabled(std::move(id), false, std::move(proc));
 	}
 
+	/**
+	 * @brief Add a benchmark to the test suite.
+	 * The benchmark is a test case which measures the time of one iteration of the
+	 * benchmark loop, see benchmark_state. The number of iterations is calibrated
+	 * automatically. Benchmarks are never run in parallel with other test cases.
+	 * Benchmark fails in case the benchmark procedure fails a check or throws.
+	 * @param id - id of the benchmark.
+	 * @param flags - test marks.
+	 * @param props - test case properties.
+	 * @param proc - benchmark procedure.
+	 */
+	void add_benchmark(
+		std::string id,
+		utki::flags<flag> flags,
+		const properties& props,
+		std::function<void(benchmark_state&)> proc
+	);
+
+	/**
+	 * @brief Add a benchmark to the test suite.
+	 * @param id - id of the benchmark.
+	 * @param flags - test marks.
+	 * @param proc - benchmark procedure.
+	 */
+	void add_benchmark(std::string id, utki::flags<flag> flags, std::function<void(benchmark_state&)> proc)
+	{
+		this->add_benchmark(std::move(id), flags, properties(), std::move(proc));
+	}
+
+	/**
+	 * @brief Add a benchmark to the test suite.
+	 * @param id - id of the benchmark.
+	 * @param proc - benchmark procedure.
+	 */
+	void add_benchmark(std::string id, std::function<void(benchmark_state&)> proc)
+	{
+		this->add_benchmark(std::move(id), false, std::move(proc));
+	}
+
 	/**
 	 * @brief Add parametrized test case to the test suite.
 	 * For each parameter value, adds a test case to the suite.
@@ -170,17 +367,49 @@ public:
 		std::function<void(const parameter_type&)> proc
 	)
 	{
-		auto shared_proc = std::make_shared<std::function<void(const parameter_type&)>>(std::move(proc));
-		for (size_t i = 0; i != params.size(); ++i) {
+		this->add(std::move(id), flags, properties(), std::move(params), std::move(proc));
+	}
+
+	/**
+	 * @brief Add parametrized test case to the test suite.
+	 * For each parameter value, adds a test case to the suite.
+	 * The actual test case ids are composed of the provided id string and
+	 * '[index]' suffix where index is the index of the parameter.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param props - test case properties.
+	 * @param params - collection of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add(
+		std::string id,
+		utki::flags<flag> flags,
+		const properties& props,
+		std::vector<parameter_type> params,
+		std::function<void(const parameter_type&)> proc
+	)
+	{
+		if (!proc) {
+			throw std::invalid_argument("test procedure is nullptr");
+		}
+
+		// one test case range is registered, the test case procedure is called with the parameter at run time
+		size_t num_params = params.size();
+		this->add_parametrized(
+			std::move(id),
+			flags,
+			props,
+			num_params,
 			// TODO: why lint complains here on macos?
 			// "error: an exception may be thrown"
 			// NOLINTNEXTLINE(bugprone-exception-escape)
-			this->add(make_indexed_id(id, i), flags, [proc = shared_proc, param = std::move(params[i])]() {
-				ASSERT(proc)
-				ASSERT(*proc)
-				(*proc)(param);
-			});
-		}
+			[params = std::move(params), proc = std::move(proc)](size_t index) {
+				ASSERT(index < params.size())
+				proc(params[index]);
+			}
+		);
 	}
 
 	/**
@@ -203,6 +432,113 @@ public:
 		this->add(std::move(id), false, std::move(params), std::move(proc));
 	}
 
+	/**
+	 * @brief Add parametrized test case with lazily generated parameters to the test suite.
+	 * For each parameter index, adds a test case to the suite.
+	 * The actual test case ids are composed of the provided id string and
+	 * '[index]' suffix where index is the index of the parameter.
+	 * The parameter is generated right before calling the test procedure,
+	 * so the parameters are not kept in memory. The test cases are registered
+	 * as a single range, their ids are composed only when needed.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param props - test case properties.
+	 * @param params - generator of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add(
+		std::string id,
+		utki::flags<flag> flags,
+		const properties& props,
+		generator<parameter_type> params,
+		std::function<void(const typename generator<parameter_type>::value_type&)> proc
+	)
+	{
+		if (!proc) {
+			throw std::invalid_argument("test procedure is nullptr");
+		}
+
+		size_t num_params = params.size();
+		this->add_parametrized(
+			std::move(id),
+			flags,
+			props,
+			num_params,
+			[params = std::move(params), proc = std::move(proc)](size_t index) {
+				proc(params[index]);
+			}
+		);
+	}
+
+	/**
+	 * @brief Add parametrized test case with lazily generated parameters to the test suite.
+	 * For each parameter index, adds a test case to the suite.
+	 * The actual test case ids are composed of the provided id string and
+	 * '[index]' suffix where index is the index of the parameter.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param params - generator of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add(
+		std::string id,
+		utki::flags<flag> flags,
+		generator<parameter_type> params,
+		std::function<void(const typename generator<parameter_type>::value_type&)> proc
+	)
+	{
+		this->add(std::move(id), flags, properties(), std::move(params), std::move(proc));
+	}
+
+	/**
+	 * @brief Add parametrized test case with lazily generated parameters to the test suite.
+	 * For each parameter index, adds a test case to the suite.
+	 * The actual test case ids are composed of the provided id string and
+	 * '[index]' suffix where index is the index of the parameter.
+	 * @param id - id of the test case.
+	 * @param params - generator of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add(
+		std::string id, //
+		generator<parameter_type> params,
+		std::function<void(const typename generator<parameter_type>::value_type&)> proc
+	)
+	{
+		this->add(std::move(id), false, std::move(params), std::move(proc));
+	}
+
+	/**
+	 * @brief Add disabled parametrized test case to the test suite.
+	 * For each parameter value, adds a test case to the suite.
+	 * The actual test case ids are composed of the provided id string and
+	 * '[index]' suffix where index is the index of the parameter. Note, that
+	 * parameter type has to be indicated as a template argument of the function.
+	 * This method is same as corresponding 'add()' method but it
+	 * implicitly adds a 'disabled' mark to the test case.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param params - collection of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add_disabled(
+		std::string id,
+		utki::flags<flag> flags,
+		std::vector<parameter_type> params,
+		std::function<void(const parameter_type&)> proc
+	)
+	{
+		this->add_disabled(std::move(id), flags, properties(), std::move(params), std::move(proc));
+	}
+
 	/**
 	 * @brief Add disabled parametrized test case to the test suite.
 	 * For each parameter value, adds a test case to the suite.
@@ -213,6 +549,7 @@ public:
 	 * implicitly adds a 'disabled' mark to the test case.
 	 * @param id - id of the test case.
 	 * @param flags - test marks.
+	 * @param props - test case properties.
 	 * @param params - collection of test procedure parameters.
 	 * @param proc - test procedure which takes a const reference to a parameter
 	 * as argument.
@@ -221,12 +558,13 @@ public:
 	void add_disabled(
 		std::string id,
 		utki::flags<flag> flags,
+		const properties& props,
 		std::vector<parameter_type> params,
 		std::function<void(const parameter_type&)> proc
 	)
 	{
 		flags.set(flag::disabled);
-		this->add(std::move(id), flags, std::move(params), std::move(proc));
+		this->add(std::move(id), flags, props, std::move(params), std::move(proc));
 	}
 
 	/**
@@ -251,6 +589,70 @@ public:
 	{
 		this->add_disabled(std::move(id), false, std::move(params), std::move(proc));
 	}
+
+	/**
+	 * @brief Add disabled parametrized test case with lazily generated parameters to the test suite.
+	 * This method is same as corresponding 'add()' method but it
+	 * implicitly adds a 'disabled' mark to the test case.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param props - test case properties.
+	 * @param params - generator of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add_disabled(
+		std::string id,
+		utki::flags<flag> flags,
+		const properties& props,
+		generator<parameter_type> params,
+		std::function<void(const typename generator<parameter_type>::value_type&)> proc
+	)
+	{
+		flags.set(flag::disabled);
+		this->add(std::move(id), flags, props, std::move(params), std::move(proc));
+	}
+
+	/**
+	 * @brief Add disabled parametrized test case with lazily generated parameters to the test suite.
+	 * This method is same as corresponding 'add()' method but it
+	 * implicitly adds a 'disabled' mark to the test case.
+	 * @param id - id of the test case.
+	 * @param flags - test marks.
+	 * @param params - generator of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add_disabled(
+		std::string id,
+		utki::flags<flag> flags,
+		generator<parameter_type> params,
+		std::function<void(const typename generator<parameter_type>::value_type&)> proc
+	)
+	{
+		this->add_disabled(std::move(id), flags, properties(), std::move(params), std::move(proc));
+	}
+
+	/**
+	 * @brief Add disabled parametrized test case with lazily generated parameters to the test suite.
+	 * This method is same as corresponding 'add()' method but it
+	 * implicitly adds a 'disabled' mark to the test case.
+	 * @param id - id of the test case.
+	 * @param params - generator of test procedure parameters.
+	 * @param proc - test procedure which takes a const reference to a parameter
+	 * as argument.
+	 */
+	template <class parameter_type>
+	void add_disabled(
+		std::string id,
+		generator<parameter_type> params,
+		std::function<void(const typename generator<parameter_type>::value_type&)> proc
+	)
+	{
+		this->add_disabled(std::move(id), false, std::move(params), std::move(proc));
+	}
 };
 
 } // namespace tst
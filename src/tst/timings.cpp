@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "timings.hxx"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include "results_db.hxx"
+
+using namespace tst;
+
+void timings::update_averages()
+{
+	uint64_t total_ms = 0;
+	size_t total_num = 0;
+
+	for (auto& s : this->suites) {
+		uint64_t suite_ms = 0;
+		for (const auto& t : s.second.tests) {
+			suite_ms += t.second;
+		}
+		if (!s.second.tests.empty()) {
+			s.second.average_ms = uint32_t(suite_ms / s.second.tests.size());
+		}
+		total_ms += suite_ms;
+		total_num += s.second.tests.size();
+	}
+
+	if (total_num != 0) {
+		this->average_ms = uint32_t(total_ms / total_num);
+	}
+}
+
+void timings::load(const std::string& file_name)
+{
+	std::ifstream f(file_name, std::ios::binary);
+	if (!f.is_open()) {
+		return;
+	}
+
+	std::string line;
+	for (size_t line_num = 1; std::getline(f, line); ++line_num) {
+		if (line.empty() || line.front() == '#') {
+			continue;
+		}
+
+		std::istringstream ss(line);
+
+		std::string suite;
+		std::string test;
+		uint32_t duration_ms = 0;
+
+		ss >> suite >> test >> duration_ms;
+		if (ss.fail()) {
+			std::stringstream err;
+			err << "error in timings file '" << file_name << "' syntax at line: " << line_num;
+			throw std::invalid_argument(err.str());
+		}
+
+		this->suites[suite].tests[test] = duration_ms;
+	}
+
+	this->update_averages();
+}
+
+void timings::load(const results_db& db)
+{
+	for (size_t i = 0; i != db.size(); ++i) {
+		auto runs = db.runs(i);
+		if (runs.empty()) {
+			continue;
+		}
+		this->suites[std::string(db.suite(i))].tests[std::string(db.test(i))] = runs[0].duration_ms;
+	}
+
+	this->update_averages();
+}
+
+void timings::save(const std::string& file_name) const
+{
+	std::ofstream f(file_name, std::ios::binary);
+
+	f << "# test durations in milliseconds: <suite> <test> <duration>" << '\n';
+
+	// the timings are sorted by test id, so that same timings always produce the same file
+	for (const auto& s : this->suites) {
+		for (const auto& t : s.second.tests) {
+			f << s.first << ' ' << t.first << ' ' << t.second << '\n';
+		}
+	}
+
+	f.flush();
+}
+
+void timings::set(std::string_view suite, std::string_view test, uint32_t duration_ms)
+{
+	auto si = this->suites.find(suite);
+	if (si == this->suites.end()) {
+		si = this->suites.emplace(std::string(suite), suite_timings()).first;
+	}
+
+	auto& tests = si->second.tests;
+	auto ti = tests.find(test);
+	if (ti == tests.end()) {
+		tests.emplace(std::string(test), duration_ms);
+	} else {
+		ti->second = duration_ms;
+	}
+}
+
+uint32_t timings::estimate(std::string_view suite, std::string_view test) const
+{
+	auto si = this->suites.find(suite);
+	if (si == this->suites.end()) {
+		return this->average_ms;
+	}
+
+	const auto& s = si->second;
+
+	auto ti = s.tests.find(test);
+	if (ti == s.tests.end()) {
+		return s.average_ms;
+	}
+
+	return ti->second;
+}
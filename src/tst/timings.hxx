@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace tst {
+
+class results_db;
+
+/**
+ * @brief Historical test durations.
+ * Durations of the tests from previous runs are used to estimate how long
+ * each test will take, so that the longest tests can be started first.
+ */
+class timings
+{
+	struct suite_timings {
+		std::map<std::string, uint32_t, std::less<>> tests;
+
+		// average test duration in the suite, used as an estimate for unknown tests
+		uint32_t average_ms = 0;
+	};
+
+	// std::less<> allows lookup by std::string_view without constructing a temporary std::string
+	std::map<std::string, suite_timings, std::less<>> suites;
+
+	// average test duration over all suites, used as an estimate for tests of
+	// unknown suites
+	uint32_t average_ms = 0;
+
+	void update_averages();
+
+public:
+	/**
+	 * @brief Check if there are no timings.
+	 * @return true if no timings were loaded or set.
+	 */
+	bool empty() const noexcept
+	{
+		return this->suites.empty();
+	}
+
+	/**
+	 * @brief Load timings from file.
+	 * In case the file does not exist, nothing is loaded.
+	 * @param file_name - name of the file to load timings from.
+	 * @throw std::invalid_argument - in case of syntax error in the file.
+	 */
+	void load(const std::string& file_name);
+
+	/**
+	 * @brief Load timings from results database.
+	 * The duration of the latest run of each test is used.
+	 * @param db - results database to load timings from.
+	 */
+	void load(const results_db& db);
+
+	/**
+	 * @brief Save timings to file.
+	 * @param file_name - name of the file to save timings to.
+	 */
+	void save(const std::string& file_name) const;
+
+	/**
+	 * @brief Set test duration.
+	 * @param suite - test suite name.
+	 * @param test - test case name.
+	 * @param duration_ms - test duration in milliseconds.
+	 */
+	void set(std::string_view suite, std::string_view test, uint32_t duration_ms);
+
+	/**
+	 * @brief Estimate test duration.
+	 * In case the test duration is not known, the average test duration of the test suite is returned.
+	 * In case the test suite is not known, the average test duration of all known tests is returned.
+	 * @param suite - test suite name.
+	 * @param test - test case name.
+	 * @return estimated test duration in milliseconds.
+	 */
+	uint32_t estimate(std::string_view suite, std::string_view test) const;
+};
+
+} // namespace tst
@@ -0,0 +1,248 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "tracer.hxx"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "settings.hxx"
+
+using namespace tst;
+
+namespace {
+using clock = std::chrono::steady_clock;
+
+// initialized before main(), so before any worker processes are forked
+const clock::time_point start_time = clock::now();
+
+const std::thread::id main_thread_id = std::this_thread::get_id();
+
+// thread ids of worker processes start from this value
+constexpr const size_t worker_tid_base = 10000;
+} // namespace
+
+namespace {
+struct event {
+	// empty for test events
+	std::string_view phase;
+
+	// empty for phase events
+	std::string_view suite;
+
+	// ids of parametrized test cases are composed on demand, so the test id is stored in the event
+	std::string test;
+
+	const char* status = nullptr;
+
+	trace_span span;
+
+	size_t tid;
+};
+
+// Events are only added by the owning thread, the mutex is needed only to read
+// the events when writing the trace, so it is never contended during the run.
+struct thread_buffer {
+	size_t tid = 0;
+	bool is_main_thread = false;
+
+	std::mutex mutex;
+	std::vector<event> events;
+};
+
+struct registry {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<thread_buffer>> buffers;
+
+	static registry& inst()
+	{
+		static registry r;
+		return r;
+	}
+};
+
+thread_buffer& this_thread_buffer()
+{
+	thread_local thread_buffer* buffer = nullptr;
+	if (!buffer) {
+		auto& r = registry::inst();
+		std::lock_guard<decltype(r.mutex)> lock_guard(r.mutex);
+
+		auto b = std::make_unique<thread_buffer>();
+		b->tid = r.buffers.size();
+		b->is_main_thread = std::this_thread::get_id() == main_thread_id;
+		buffer = b.get();
+		r.buffers.push_back(std::move(b));
+	}
+	return *buffer;
+}
+
+void record(event e)
+{
+	auto& b = this_thread_buffer();
+	std::lock_guard<decltype(b.mutex)> lock_guard(b.mutex);
+	if (e.tid == 0) {
+		e.tid = b.tid;
+	}
+	b.events.push_back(std::move(e));
+}
+} // namespace
+
+bool tracer::is_enabled() noexcept
+{
+	return !settings::inst().trace_out_file.empty();
+}
+
+uint64_t tracer::now_us() noexcept
+{
+	return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start_time).count());
+}
+
+void tracer::record_test(const full_id& id, suite::status result, trace_span span, std::optional<size_t> worker)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	event e{};
+	e.suite = id.suite;
+	e.test = id.test;
+	e.status = suite::status_to_string(result);
+	e.span = span;
+	if (worker) {
+		e.tid = worker_tid_base + worker.value();
+	}
+	record(std::move(e));
+}
+
+void tracer::record_phase(std::string_view name, trace_span span)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	event e{};
+	e.phase = name;
+	e.span = span;
+	record(std::move(e));
+}
+
+namespace {
+void write_json_string(std::ostream& o, std::string_view s)
+{
+	o << '"';
+	for (auto c : s) {
+		if (c == '"' || c == '\\') {
+			o << '\\';
+		}
+		o << c;
+	}
+	o << '"';
+}
+} // namespace
+
+namespace {
+void write_thread_name(std::ostream& o, size_t tid, std::string_view name)
+{
+	o << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid << R"(,"args":{"name":)";
+	write_json_string(o, name);
+	o << "}}";
+}
+} // namespace
+
+namespace {
+void write_event(std::ostream& o, const event& e)
+{
+	o << R"({"name":)";
+	if (e.phase.empty()) {
+		write_json_string(o, std::string(e.suite).append(1, ' ').append(e.test));
+		o << R"(,"cat":"test")";
+	} else {
+		write_json_string(o, e.phase);
+		o << R"(,"cat":"phase")";
+	}
+	o << R"(,"ph":"X","ts":)" << e.span.begin_us << R"(,"dur":)" << (e.span.end_us - e.span.begin_us)
+	  << R"(,"pid":1,"tid":)" << e.tid;
+	if (e.phase.empty()) {
+		o << R"(,"args":{"suite":)";
+		write_json_string(o, e.suite);
+		o << R"(,"test":)";
+		write_json_string(o, e.test);
+		o << R"(,"status":)";
+		write_json_string(o, e.status);
+		o << '}';
+	}
+	o << '}';
+}
+} // namespace
+
+// See https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+// for the trace event format
+void tracer::write(const std::string& file_name)
+{
+	std::ofstream f(file_name, std::ios::binary);
+
+	f << R"({"displayTimeUnit":"ms","traceEvents":[)" << '\n';
+
+	bool first = true;
+	auto separate = [&]() {
+		if (!first) {
+			f << ',' << '\n';
+		}
+		first = false;
+	};
+
+	std::set<size_t> workers;
+
+	auto& r = registry::inst();
+	std::lock_guard<decltype(r.mutex)> registry_lock_guard(r.mutex);
+	for (const auto& b : r.buffers) {
+		std::lock_guard<decltype(b->mutex)> lock_guard(b->mutex);
+
+		separate();
+		write_thread_name(f, b->tid, b->is_main_thread ? "main" : "runner " + std::to_string(b->tid));
+
+		for (const auto& e : b->events) {
+			if (e.tid >= worker_tid_base) {
+				workers.insert(e.tid);
+			}
+			separate();
+			write_event(f, e);
+		}
+	}
+
+	for (auto tid : workers) {
+		separate();
+		write_thread_name(f, tid, "worker " + std::to_string(tid - worker_tid_base));
+	}
+
+	f << '\n' << "]}" << '\n';
+}
@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2021-2025 Ivan Gagis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "suite.hpp"
+#include "util.hxx"
+
+namespace tst {
+
+/**
+ * @brief Time interval in microseconds since the tracer start.
+ */
+struct trace_span {
+	uint64_t begin_us;
+	uint64_t end_us;
+};
+
+/**
+ * @brief Recorder of trace events, see --trace-out.
+ * The events are recorded to per-thread buffers and written to a file in
+ * Chrome trace event format at the end of the run.
+ * All functions do nothing in case tracing is not enabled.
+ */
+class tracer
+{
+public:
+	/**
+	 * @brief Check if tracing is enabled.
+	 * @return true in case --trace-out is given.
+	 */
+	static bool is_enabled() noexcept;
+
+	/**
+	 * @brief Get current time.
+	 * The clock is monotonic and is shared with the forked worker processes.
+	 * @return number of microseconds since the tracer start.
+	 */
+	static uint64_t now_us() noexcept;
+
+	/**
+	 * @brief Record test case run.
+	 * @param id - test id.
+	 * @param result - test result.
+	 * @param span - time interval of the test run.
+	 * @param worker - index of the worker process which has run the test.
+	 *                 Empty in case the test has been run by the calling thread.
+	 */
+	static void record_test(
+		const full_id& id,
+		suite::status result,
+		trace_span span,
+		std::optional<size_t> worker = std::nullopt
+	);
+
+	/**
+	 * @brief Record phase of the run.
+	 * @param name - phase name.
+	 * @param span - time interval of the phase.
+	 */
+	static void record_phase(std::string_view name, trace_span span);
+
+	/**
+	 * @brief Write recorded events to a file.
+	 * @param file_name - name of the file to write.
+	 */
+	static void write(const std::string& file_name);
+};
+
+/**
+ * @brief Records phase of the run when goes out of scope.
+ */
+class trace_phase
+{
+	std::string_view name;
+	uint64_t begin_us;
+
+public:
+	trace_phase(std::string_view name) :
+		name(name),
+		begin_us(tracer::now_us())
+	{}
+
+	trace_phase(const trace_phase&) = delete;
+	trace_phase& operator=(const trace_phase&) = delete;
+
+	trace_phase(trace_phase&&) = delete;
+	trace_phase& operator=(trace_phase&&) = delete;
+
+	~trace_phase()
+	{
+		tracer::record_phase(this->name, {this->begin_us, tracer::now_us()});
+	}
+};
+
+} // namespace tst
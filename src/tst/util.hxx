@@ -27,6 +27,7 @@ SOFTWARE.
 #pragma once
 
 #include <string>
+#include <string_view>
 
 #include <utki/debug.hpp>
 
@@ -44,9 +45,34 @@ public:
 	{}
 };
 
-struct full_id {
-	const std::string& suite;
-	const std::string& test;
+// Id of a test case. The id of a parametrized test case is composed on demand,
+// in that case the id is stored in the object, so the object is not copyable.
+class full_id
+{
+	std::string test_storage;
+
+public:
+	const std::string_view suite;
+	const std::string_view test;
+
+	full_id(std::string_view suite, std::string_view test) :
+		suite(suite),
+		test(test)
+	{}
+
+	full_id(std::string_view suite, std::string&& test) :
+		test_storage(std::move(test)),
+		suite(suite),
+		test(this->test_storage)
+	{}
+
+	full_id(const full_id&) = delete;
+	full_id& operator=(const full_id&) = delete;
+
+	full_id(full_id&&) = delete;
+	full_id& operator=(full_id&&) = delete;
+
+	~full_id() = default;
 };
 
 inline bool is_valid_id_char(char c)
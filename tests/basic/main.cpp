@@ -1,9 +1,15 @@
+#include "../../src/tst/alloc_hook.hpp"
 #include "../../src/tst/check.hpp"
 #include "../../src/tst/set.hpp"
 
 #include "../harness/testees.hpp"
 
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
 #include <thread>
+#include <vector>
 
 // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
 
@@ -202,4 +208,273 @@ const tst::set parametrized_set("paramterized_by_string", [](tst::suite& suite){
 });
 }
 
+namespace{
+// number of tests currently using the shared resource
+std::atomic<int> num_resource_users = 0;
+
+const tst::set resources_set("exclusive_resources", [](tst::suite& suite){
+	tst::properties props;
+	props.resources = {"shared_resource"};
+
+	suite.add<int>(
+		"tests_using_same_resource_do_not_run_concurrently",
+		false,
+		props,
+		{1, 2, 3, 4},
+		[](auto&){
+			tst::check_eq(++num_resource_users, 1, SL);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			--num_resource_users;
+		}
+	);
+});
+}
+
+namespace{
+// number of heavy tests currently running
+std::atomic<int> num_heavy_tests_running = 0;
+
+// number of light tests currently running
+std::atomic<int> num_light_tests_running = 0;
+
+const tst::set weights_set("weighted_tests", [](tst::suite& suite){
+	tst::properties props;
+
+	// weight is larger than any number of jobs, it is reduced to the CPU budget, so the test runs alone
+	props.cpu_weight = 100000;
+
+	suite.add<int>(
+		"heavy_tests_do_not_run_concurrently",
+		false,
+		props,
+		{1, 2, 3},
+		[](auto&){
+			tst::check_eq(++num_heavy_tests_running, 1, SL);
+			tst::check_eq(num_light_tests_running.load(), 0, SL);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			tst::check_eq(num_light_tests_running.load(), 0, SL);
+			--num_heavy_tests_running;
+		}
+	);
+
+	suite.add<int>(
+		"light_tests_do_not_run_along_with_heavy_test",
+		{1, 2, 3, 4},
+		[](auto&){
+			++num_light_tests_running;
+			tst::check_eq(num_heavy_tests_running.load(), 0, SL);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			tst::check_eq(num_heavy_tests_running.load(), 0, SL);
+			--num_light_tests_running;
+		}
+	);
+});
+}
+
+namespace{
+const tst::set benchmarks_set("benchmarks", [](tst::suite& suite){
+	suite.add_benchmark(
+		"factorial_of_10",
+		[](tst::benchmark_state& state){
+			int n = 10;
+			while(state.keep_running()){
+				tst::do_not_optimize(n);
+				tst::do_not_optimize(factorial(n));
+			}
+		}
+	);
+});
+}
+
+namespace{
+const tst::set alloc_tracking_set("alloc_tracking", [](tst::suite& suite){
+	suite.add(
+		"allocations_are_counted",
+		[](){
+			tst::check(tst::alloc_tracker::is_installed(), SL);
+
+			auto before = tst::alloc_tracker::get_thread_stats();
+			auto a = std::make_unique<std::array<char, 100>>();
+			auto b = std::make_unique<std::array<char, 200>>();
+			b.reset();
+			auto after = tst::alloc_tracker::get_thread_stats();
+
+			tst::check_eq(after.num_allocs - before.num_allocs, uint64_t(2), SL);
+			tst::check_eq(after.num_bytes - before.num_bytes, uint64_t(300), SL);
+			tst::check_ge(after.peak_bytes, uint64_t(300), SL);
+		}
+	);
+
+	suite.add(
+		"over_aligned_allocation",
+		[](){
+			struct alignas(128) over_aligned{
+				char c;
+			};
+
+			auto before = tst::alloc_tracker::get_thread_stats();
+			auto p = std::make_unique<over_aligned>();
+			auto after = tst::alloc_tracker::get_thread_stats();
+
+			tst::check_eq(reinterpret_cast<uintptr_t>(p.get()) % alignof(over_aligned), uintptr_t(0), SL);
+			tst::check_eq(after.num_allocs - before.num_allocs, uint64_t(1), SL);
+		}
+	);
+
+	suite.add(
+		"passing_check_does_not_allocate",
+		[](){
+			// the captures do not fit into small buffer of std::function
+			std::array<char, 100> big_capture{};
+
+			auto before = tst::alloc_tracker::get_thread_stats();
+			tst::check(true, [big_capture](auto& o){o << big_capture.size();}, SL);
+			tst::check_eq(1, 1, SL);
+			auto after = tst::alloc_tracker::get_thread_stats();
+
+			tst::check_eq(after.num_allocs - before.num_allocs, uint64_t(0), SL);
+		}
+	);
+
+	suite.add(
+		"no_alloc_scope_without_allocations",
+		[](){
+			std::vector<int> v(10);
+
+			uint64_t num_allocs = 0;
+			{
+				tst::no_alloc_scope no_alloc(SL);
+				for(auto& e : v){
+					e = factorial(5);
+				}
+				num_allocs = no_alloc.num_allocs();
+			}
+			tst::check_eq(num_allocs, uint64_t(0), SL);
+			tst::check_eq(v.back(), 120, SL);
+		}
+	);
+});
+}
+
+namespace{
+const tst::set span_checks_set("span_checks", [](tst::suite& suite){
+	suite.add(
+		"equal_byte_spans",
+		[](){
+			std::vector<uint8_t> a(100000);
+			for(size_t i = 0; i != a.size(); ++i){
+				a[i] = uint8_t(i);
+			}
+			auto b = a;
+			tst::check_eq(utki::make_span(a), utki::make_span(b), SL);
+			tst::check_eq(a, b, SL);
+		}
+	);
+
+	suite.add(
+		"equal_string_vectors",
+		[](){
+			std::vector<std::string> a = {"hello", "world"};
+			auto b = a;
+			tst::check_eq(a, b, [](auto& o){o << "hello world!";}, SL);
+		}
+	);
+
+	suite.add(
+		"equal_bool_vectors",
+		[](){
+			std::vector<bool> a = {true, false, true, true};
+			auto b = a;
+			tst::check_eq(a, b, SL);
+			tst::check_eq(a, b, [](auto& o){o << "hello world!";}, SL);
+		}
+	);
+
+	suite.add(
+		"near_floats",
+		[](){
+			tst::check_near(1.0f, 1.0f + 1e-7f, 1e-6f, SL);
+			tst::check_near(1000.0, 1000.0001, 1e-6, SL);
+			tst::check_ulp(1.0f, std::nextafter(1.0f, 2.0f), 1, SL);
+			tst::check_ulp(0.0, -0.0, 0, SL);
+
+			std::vector<double> a(100000);
+			for(size_t i = 0; i != a.size(); ++i){
+				a[i] = std::sin(double(i));
+			}
+			auto b = a;
+			b[10] = std::nextafter(b[10], 2.0);
+			tst::check_near(a, b, 1e-12, SL);
+			tst::check_ulp(utki::make_span(a), utki::make_span(b), 1, SL);
+		}
+	);
+
+	suite.add(
+		"empty_spans",
+		[](){
+			tst::check_eq(utki::span<const int>(), utki::span<const int>(), SL);
+		}
+	);
+});
+}
+
+namespace{
+const tst::set generated_params_set("generated_params", [](tst::suite& suite){
+	suite.add(
+		"factorial_of_generated_value",
+		tst::generator<std::pair<int, int>>(
+			4,
+			[](size_t i){
+				constexpr std::array<int, 4> expected = {1, 1, 2, 6};
+				return std::make_pair(int(i), expected.at(i));
+			}
+		),
+		[](const auto& p){
+			tst::check_eq(factorial(p.first), p.second, SL);
+		}
+	);
+
+	suite.add(
+		"cartesian_product",
+		tst::cartesian(
+			tst::generator<int>(3, [](size_t i){return int(i) + 1;}),
+			tst::generator<std::string>(2, [](size_t i){return std::string(i + 1, 'a');})
+		),
+		[](const auto& p){
+			const auto& [n, str] = p;
+			tst::check(1 <= n && n <= 3, SL);
+			tst::check(str == "a" || str == "aa", SL);
+		}
+	);
+});
+}
+
+namespace{
+void factorial_of_zero_is_one(){
+	tst::check_eq(factorial(0), 1, SL);
+}
+
+void factorial_of_five(){
+	tst::check_eq(factorial(5), 120, SL);
+}
+
+constexpr std::array<tst::test_entry, 2> static_tests = {{
+	{"factorial_of_zero_is_one", &factorial_of_zero_is_one},
+	{"factorial_of_five", &factorial_of_five}
+}};
+
+const tst::static_set static_set1("static_tables", static_tests);
+}
+
+namespace{
+constexpr tst::test_entry more_static_tests[] = {
+	{"lambda_converted_to_function_pointer", [](){
+		tst::check_eq(factorial(3), 6, SL);
+	}}
+};
+
+// second table of the same suite
+const tst::static_set static_set2("static_tables", more_static_tests);
+}
+
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
@@ -1,6 +1,10 @@
 #include "../../src/tst/set.hpp"
 #include "../../src/tst/check.hpp"
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 namespace{
 const tst::set set("failing_checks", [](auto& suite){
     suite.add("check", [](){
@@ -58,5 +62,56 @@ const tst::set set("failing_checks", [](auto& suite){
     suite.add("check_ge_print", [](){
         tst::check_ge(2, 3, [](auto&o){o << "failed!";}, SL);
     });
+
+    suite.add("check_eq_span", [](){
+        std::vector<uint8_t> a(10000, 0xab);
+        auto b = a;
+        b[5000] = 0;
+        b[9999] = 0;
+        tst::check_eq(utki::make_span(a), utki::make_span(b), SL) << "Hello world!";
+    });
+
+    suite.add("check_near", [](){
+        tst::check_near(1.0f, 1.1f, 1e-3f, SL) << "Hello world!";
+    });
+
+    suite.add("check_ulp_print", [](){
+        tst::check_ulp(1.0, 1.0000000001, 4, [](auto&o){o << "failed!";}, SL);
+    });
+
+    suite.add("check_near_span", [](){
+        std::vector<float> a(1000, 1.0f);
+        auto b = a;
+        b[10] = 1.5f;
+        b[20] = 1.0001f;
+        b[30] = std::numeric_limits<float>::quiet_NaN();
+        tst::check_near(utki::make_span(a), utki::make_span(b), 1e-6f, SL) << "Hello world!";
+    });
+
+    suite.add("check_ulp_span_zero_ulps", [](){
+        std::vector<float> a(1000, 1.0f);
+        auto b = a;
+        b[10] = std::nextafter(1.0f, 2.0f);
+        b[20] = 1.001f;
+        tst::check_ulp(utki::make_span(a), utki::make_span(b), 0, SL) << "Hello world!";
+    });
+
+    suite.add("check_ulp_vector_print", [](){
+        std::vector<double> a = {1.0, 2.0, 3.0};
+        std::vector<double> b = {1.0, 2.0000001, 3.0};
+        tst::check_ulp(a, b, 2, [](auto&o){o << "failed!";}, SL);
+    });
+
+    suite.add("check_eq_vector_print", [](){
+        std::vector<int> a = {1, 2, 3, 4};
+        std::vector<int> b = {1, 2, 5};
+        tst::check_eq(a, b, [](auto&o){o << "failed!";}, SL);
+    });
+
+    suite.add("check_eq_bool_vector", [](){
+        std::vector<bool> a = {true, false, true};
+        std::vector<bool> b = {true, true, true};
+        tst::check_eq(a, b, SL) << "Hello world!";
+    });
 });
 }
@@ -1,3 +1,4 @@
+#include "../../src/tst/alloc_hook.hpp"
 #include "../../src/tst/application.hpp"
 #include "../../src/tst/check.hpp"
 
@@ -5,6 +6,9 @@
 
 #include <utki/exception.hpp>
 
+#include <memory>
+#include <thread>
+
 // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
 
 namespace{
@@ -33,10 +37,19 @@ struct some_unknown_exception{};
 }
 
 class application : public tst::application{
+	bool add_crashing_test = false;
 public:
 	application() :
 			tst::application("failing tests", "some tests are failing")
-	{}
+	{
+		this->cli.add(
+			"crashing-test",
+			"add a test which crashes the process, only to be used with --jobs-mode=process",
+			[this](){
+				this->add_crashing_test = true;
+			}
+		);
+	}
 
 	void init()override;
 };
@@ -46,6 +59,54 @@ void application::init(){
 
 	auto& suite = this->get_suite("factorial");
 
+	if(this->add_crashing_test){
+		suite.add(
+				"test_which_crashes_the_process",
+				[](){
+					std::abort();
+				}
+			);
+	}
+
+	{
+		tst::properties props;
+		props.timeout = std::chrono::milliseconds(100);
+		props.resources = {"resource_of_hung_test"};
+
+		suite.add(
+				"test_which_times_out",
+				false,
+				props,
+				[](){
+					// simulate hung test
+					std::this_thread::sleep_for(std::chrono::seconds(3));
+				}
+			);
+	}
+
+	{
+		// in case this test is scheduled after the hung test has started,
+		// it is not run, because the resource stays held by the hung test
+		tst::properties props;
+		props.resources = {"resource_of_hung_test"};
+
+		suite.add(
+				"test_which_uses_resource_of_hung_test",
+				false,
+				props,
+				[](){}
+			);
+	}
+
+	suite.add_benchmark(
+			"benchmark_which_regresses",
+			[](tst::benchmark_state& state){
+				while(state.keep_running()){
+					tst::do_not_optimize(factorial(10));
+				}
+			}
+		);
+
 	suite.add(
 			"positive_arguments_must_produce_expected_result",
 			[](){
@@ -136,6 +197,14 @@ void application::init(){
 			}
 		);
 
+	suite.add(
+			"test_which_allocates_in_no_alloc_scope",
+			[](){
+				tst::no_alloc_scope no_alloc(SL);
+				auto p = std::make_unique<int>(factorial(3)); // will fail
+			}
+		);
+
 	suite.add_disabled("disabled_test", [](){tst::check(false, SL);});
 
 	suite.add(